@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Contention benchmark: editorconfig_parse() is called over and over on a
+ * shared set of paths from 1, 2, 4... up to N threads, with warm caches,
+ * and the throughput of each thread count is printed as JSON together with
+ * how often the locks of the library caches made a thread wait.
+ *
+ * Usage: editorconfig_contention [--threads N] [--duration MS] [FILE]
+ * The paths are read from FILE, or from stdin, one per line; the output of
+ * editorconfig_gentree will do.
+ */
+
+#include "global.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <editorconfig/editorconfig.h>
+
+typedef struct
+{
+    char**          paths;
+    size_t          count;
+    /* set by the main thread when the time is up */
+    int             stop;
+    /* calls made by all the threads */
+    uint64_t        queries;
+    int             failed;
+} shared_state;
+
+typedef struct
+{
+    shared_state*   shared;
+    /* where in the paths this thread starts, so that the threads do not
+     * walk in lockstep */
+    size_t          start;
+} thread_state;
+
+static uint64_t now_ns(void)
+{
+    struct timespec     ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void* hammer(void* context)
+{
+    thread_state*           ts = (thread_state*)context;
+    shared_state*           shared = ts->shared;
+    editorconfig_handle     eh = editorconfig_handle_init();
+    size_t                  i = ts->start;
+    uint64_t                queries = 0;
+
+    if (eh == NULL) {
+        __atomic_store_n(&shared->failed, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    while (!__atomic_load_n(&shared->stop, __ATOMIC_RELAXED)) {
+        editorconfig_parse(shared->paths[i], eh);
+        ++ queries;
+        if (++i == shared->count)
+            i = 0;
+    }
+
+    __atomic_fetch_add(&shared->queries, queries, __ATOMIC_RELAXED);
+    editorconfig_handle_destroy(eh);
+    return NULL;
+}
+
+/*
+ * Reads the paths, one per line, from f. Returns NULL if out of memory.
+ */
+static char** read_paths(FILE* f, size_t* count)
+{
+    size_t      capacity = 1024;
+    char**      paths = (char**)malloc(capacity * sizeof(char*));
+    char        line[4096];
+
+    *count = 0;
+    while (paths && fgets(line, sizeof(line), f)) {
+        size_t  len = strcspn(line, "\r\n");
+
+        if (len == 0)
+            continue;
+        line[len] = '\0';
+        if (*count == capacity) {
+            char**  grown = (char**)realloc(paths,
+                    capacity * 2 * sizeof(char*));
+
+            if (grown == NULL) {
+                free(paths);
+                return NULL;
+            }
+            paths = grown;
+            capacity *= 2;
+        }
+        if ((paths[(*count)++] = strdup(line)) == NULL)
+            return NULL;
+    }
+
+    return paths;
+}
+
+static void print_lock(const char* name, unsigned long long acquisitions,
+        unsigned long long contended, unsigned long long wait_ns)
+{
+    printf("\"%s\": {\"acquisitions\": %llu, \"contended\": %llu, "
+            "\"contended_ratio\": %.4f, \"wait_ns\": %llu}", name,
+            acquisitions, contended,
+            acquisitions ? (double)contended / acquisitions : 0, wait_ns);
+}
+
+/*
+ * Runs thread_count threads for duration_ms and prints the result. Returns
+ * the throughput, or a negative number on failure.
+ */
+static double run(shared_state* shared, int thread_count, int duration_ms,
+        double base_qps, int first)
+{
+    pthread_t*                  threads;
+    thread_state*               states;
+    editorconfig_cache_stats    before;
+    editorconfig_cache_stats    after;
+    uint64_t                    start;
+    double                      seconds;
+    double                      qps;
+    int                         started;
+    int                         i;
+
+    threads = (pthread_t*)malloc(thread_count * sizeof(pthread_t));
+    states = (thread_state*)malloc(thread_count * sizeof(thread_state));
+    if (threads == NULL || states == NULL)
+        return -1;
+
+    shared->stop = 0;
+    shared->queries = 0;
+    editorconfig_get_cache_stats(&before);
+    start = now_ns();
+    for (started = 0; started < thread_count; ++started) {
+        states[started].shared = shared;
+        states[started].start = shared->count * started / thread_count;
+        if (pthread_create(&threads[started], NULL, hammer,
+                    &states[started]))
+            break;
+    }
+    usleep((useconds_t)duration_ms * 1000);
+    __atomic_store_n(&shared->stop, 1, __ATOMIC_RELAXED);
+    for (i = 0; i < started; ++i)
+        pthread_join(threads[i], NULL);
+    seconds = (now_ns() - start) / 1e9;
+    editorconfig_get_cache_stats(&after);
+
+    free(threads);
+    free(states);
+    if (started < thread_count || shared->failed)
+        return -1;
+
+    qps = shared->queries / seconds;
+    printf("%s\n    {\"threads\": %d, \"queries\": %llu, \"seconds\": %.6f, "
+            "\"queries_per_second\": %.1f, \"speedup\": %.2f,\n     ",
+            first ? "" : ",", thread_count,
+            (unsigned long long)shared->queries, seconds, qps,
+            base_qps > 0 ? qps / base_qps : 1.0);
+    print_lock("file_cache_lock",
+            after.file_lock_acquisitions - before.file_lock_acquisitions,
+            after.file_lock_contended - before.file_lock_contended,
+            after.file_lock_wait_ns - before.file_lock_wait_ns);
+    printf(",\n     ");
+    print_lock("glob_cache_lock",
+            after.glob_lock_acquisitions - before.glob_lock_acquisitions,
+            after.glob_lock_contended - before.glob_lock_contended,
+            after.glob_lock_wait_ns - before.glob_lock_wait_ns);
+    printf("}");
+    fflush(stdout);
+
+    return qps;
+}
+
+int main(int argc, const char* argv[])
+{
+    shared_state            shared;
+    editorconfig_handle     eh;
+    const char*             file = NULL;
+    FILE*                   f = stdin;
+    int                     max_threads = 8;
+    int                     duration_ms = 1000;
+    int                     thread_count;
+    double                  base_qps = 0;
+    int                     i;
+    size_t                  p;
+
+    for (i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+            max_threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--duration") && i + 1 < argc)
+            duration_ms = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && file == NULL)
+            file = argv[i];
+        else {
+            fprintf(stderr, "Usage: %s [--threads N] [--duration MS] "
+                    "[FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (max_threads < 1 || duration_ms < 1) {
+        fprintf(stderr, "--threads and --duration must be positive.\n");
+        return 1;
+    }
+
+    if (file && (f = fopen(file, "r")) == NULL) {
+        perror(file);
+        return 1;
+    }
+    memset(&shared, 0, sizeof(shared));
+    shared.paths = read_paths(f, &shared.count);
+    if (shared.paths == NULL) {
+        perror("Unable to allocate memory");
+        return 2;
+    }
+    if (shared.count == 0) {
+        fprintf(stderr, "No paths to resolve.\n");
+        return 1;
+    }
+
+    /* warm the caches, so that all thread counts see the same state */
+    eh = editorconfig_handle_init();
+    if (eh == NULL) {
+        perror("Unable to allocate memory");
+        return 2;
+    }
+    for (p = 0; p < shared.count; ++p)
+        editorconfig_parse(shared.paths[p], eh);
+    editorconfig_handle_destroy(eh);
+
+    printf("{\"paths\": %zu, \"runs\": [", shared.count);
+    for (thread_count = 1; ; thread_count *= 2) {
+        int     n = thread_count < max_threads ? thread_count : max_threads;
+        double  qps = run(&shared, n, duration_ms, base_qps, n == 1);
+
+        if (qps < 0) {
+            perror("Benchmark failed");
+            return 1;
+        }
+        if (n == 1)
+            base_qps = qps;
+        if (n == max_threads)
+            break;
+    }
+    printf("\n]}\n");
+
+    for (p = 0; p < shared.count; ++p)
+        free(shared.paths[p]);
+    free(shared.paths);
+    if (file)
+        fclose(f);
+
+    return 0;
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Generates a directory tree with .editorconfig files for scaling
+ * benchmarks. Every dimension that the cost of a lookup depends on is a
+ * parameter: how deep the tree is, how many directories and files each
+ * directory holds, how many directories have a config, how many sections a
+ * config has, how hard its globs are and where root = true is. The same
+ * parameters and seed always give the same tree.
+ *
+ * The paths of the files are printed to stdout, one per line, so that they
+ * can be given to "editorconfig --bench --files-from -".
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+typedef struct
+{
+    /* levels of directories below the root of the tree */
+    int         depth;
+    /* directories in each directory above the last level */
+    int         fanout;
+    /* files in each directory */
+    int         files;
+    /* percentage of the directories with a .editorconfig file */
+    int         config_density;
+    /* sections in each .editorconfig file */
+    int         sections;
+    /* 0: plain globs, 1: adds braces, 2: adds ranges, character classes and
+     * nested braces */
+    int         complexity;
+    /* the level whose .editorconfig files have root = true, -1 for none */
+    int         root_level;
+    uint64_t    seed;
+} gen_options;
+
+static uint64_t     random_state;
+
+/* xorshift64*, good enough to pick names and not platform dependent */
+static uint64_t next_random(void)
+{
+    random_state ^= random_state >> 12;
+    random_state ^= random_state << 25;
+    random_state ^= random_state >> 27;
+    return random_state * 2685821657736338717ull;
+}
+
+static const char*  extensions[] = { "c", "h", "cpp", "js", "py", "md",
+    "txt", "json" };
+#define EXTENSION_COUNT ((int)(sizeof(extensions) / sizeof(extensions[0])))
+
+static const char*  properties[] = {
+    "indent_style = space", "indent_style = tab", "indent_size = 2",
+    "indent_size = 4", "tab_width = 8", "end_of_line = lf",
+    "end_of_line = crlf", "charset = utf-8", "trim_trailing_whitespace = true",
+    "insert_final_newline = true", "max_line_length = 100" };
+#define PROPERTY_COUNT ((int)(sizeof(properties) / sizeof(properties[0])))
+
+static const char* random_extension(void)
+{
+    return extensions[next_random() % EXTENSION_COUNT];
+}
+
+/*
+ * Writes the header of section i, as hard to match as the complexity asks.
+ */
+static void write_section(FILE* f, int i, int complexity)
+{
+    switch (complexity > 0 ? i % (complexity * 2 + 1) : 0) {
+    case 0:
+        fprintf(f, "[*.%s]\n", random_extension());
+        break;
+    case 1:
+        fprintf(f, "[*.{%s,%s,%s}]\n", random_extension(),
+                random_extension(), random_extension());
+        break;
+    case 2:
+        fprintf(f, "[{src,lib,d%d}/**.%s]\n",
+                (int)(next_random() % 8), random_extension());
+        break;
+    case 3:
+        fprintf(f, "[file{0..%d}.%s]\n",
+                (int)(next_random() % 64) + 1, random_extension());
+        break;
+    default:
+        fprintf(f, "[**/[a-m]*.{%s,{%s,%s}}]\n", random_extension(),
+                random_extension(), random_extension());
+        break;
+    }
+}
+
+static int write_config(const char* dir, int level, const gen_options* o)
+{
+    char        path[4096];
+    FILE*       f;
+    int         i;
+
+    snprintf(path, sizeof(path), "%s/.editorconfig", dir);
+    f = fopen(path, "w");
+    if (f == NULL)
+        return -1;
+
+    if (level == o->root_level)
+        fprintf(f, "root = true\n\n");
+    for (i = 0; i < o->sections; ++i) {
+        int     j;
+
+        write_section(f, i, o->complexity);
+        for (j = 0; j < 3; ++j)
+            fprintf(f, "%s\n",
+                    properties[next_random() % PROPERTY_COUNT]);
+        fprintf(f, "\n");
+    }
+
+    return fclose(f);
+}
+
+/*
+ * Fills in dir, which is at level, and the directories below it. path has
+ * room for 4096 characters and holds dir, it is restored before returning.
+ */
+static int generate(char* path, int level, const gen_options* o,
+        unsigned long long* file_count, unsigned long long* config_count)
+{
+    size_t      len = strlen(path);
+    int         i;
+
+    if (mkdir(path, 0777) && errno != EEXIST)
+        return -1;
+
+    /* the root level always has its config if root = true goes there */
+    if ((int)(next_random() % 100) < o->config_density ||
+            level == o->root_level) {
+        if (write_config(path, level, o))
+            return -1;
+        ++ *config_count;
+    }
+
+    for (i = 0; i < o->files; ++i) {
+        FILE*   f;
+
+        snprintf(path + len, 4096 - len, "/file%d.%s", i,
+                random_extension());
+        f = fopen(path, "w");
+        if (f == NULL || fclose(f))
+            return -1;
+        puts(path);
+        ++ *file_count;
+    }
+
+    if (level < o->depth) {
+        for (i = 0; i < o->fanout; ++i) {
+            snprintf(path + len, 4096 - len, "/d%d", i);
+            if (generate(path, level + 1, o, file_count, config_count))
+                return -1;
+        }
+    }
+
+    path[len] = '\0';
+    return 0;
+}
+
+static void usage(FILE* stream, const char* command)
+{
+    fprintf(stream, "Usage: %s [OPTIONS] DIR\n", command);
+    fprintf(stream, "Creates a tree under DIR, which must be a full path, and prints the paths of\n");
+    fprintf(stream, "its files.\n\n");
+    fprintf(stream, "--depth N           Levels of directories below DIR (default 4).\n");
+    fprintf(stream, "--fanout N          Directories in each directory (default 3).\n");
+    fprintf(stream, "--files N           Files in each directory (default 10).\n");
+    fprintf(stream, "--config-density N  Percentage of directories with a .editorconfig (default 50).\n");
+    fprintf(stream, "--sections N        Sections in each .editorconfig (default 8).\n");
+    fprintf(stream, "--complexity N      0: plain globs, 1: braces, 2: ranges, classes and nested\n");
+    fprintf(stream, "                    braces too (default 1).\n");
+    fprintf(stream, "--root-level N      Level whose .editorconfig has root = true, -1 for none\n");
+    fprintf(stream, "                    (default 0, DIR itself).\n");
+    fprintf(stream, "--seed N            Seed of the random choices (default 1).\n");
+}
+
+int main(int argc, const char* argv[])
+{
+    gen_options             o = { 4, 3, 10, 50, 8, 1, 0, 1 };
+    const char*             dir = NULL;
+    char                    path[4096];
+    unsigned long long      file_count = 0;
+    unsigned long long      config_count = 0;
+    int                     i;
+
+    for (i = 1; i < argc; ++i) {
+        int*    value = NULL;
+        char*   end;
+
+        if (!strcmp(argv[i], "--depth"))
+            value = &o.depth;
+        else if (!strcmp(argv[i], "--fanout"))
+            value = &o.fanout;
+        else if (!strcmp(argv[i], "--files"))
+            value = &o.files;
+        else if (!strcmp(argv[i], "--config-density"))
+            value = &o.config_density;
+        else if (!strcmp(argv[i], "--sections"))
+            value = &o.sections;
+        else if (!strcmp(argv[i], "--complexity"))
+            value = &o.complexity;
+        else if (!strcmp(argv[i], "--root-level"))
+            value = &o.root_level;
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            o.seed = strtoull(argv[++i], NULL, 10);
+            continue;
+        } else if (argv[i][0] != '-' && dir == NULL) {
+            dir = argv[i];
+            continue;
+        } else {
+            usage(stderr, argv[0]);
+            return 1;
+        }
+
+        if (i + 1 == argc) {
+            usage(stderr, argv[0]);
+            return 1;
+        }
+        *value = (int)strtol(argv[++i], &end, 10);
+        if (end == argv[i] || *end != '\0') {
+            usage(stderr, argv[0]);
+            return 1;
+        }
+    }
+
+    if (dir == NULL || dir[0] != '/' || strlen(dir) > 1024 ||
+            o.depth < 0 || o.fanout < 0 || o.files < 0 || o.sections < 0 ||
+            o.complexity < 0 || o.complexity > 2) {
+        usage(stderr, argv[0]);
+        return 1;
+    }
+
+    /* xorshift never leaves 0 */
+    random_state = o.seed ? o.seed : 1;
+
+    strcpy(path, dir);
+    if (generate(path, 0, &o, &file_count, &config_count)) {
+        perror(path);
+        return 1;
+    }
+
+    fprintf(stderr, "%llu files, %llu .editorconfig files\n",
+            file_count, config_count);
+    return fflush(stdout) ? 1 : 0;
+}
@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Microbenchmarks of the hot paths of the library: compiling and matching
+ * glob patterns, parsing INI data and resolving a path end to end with warm
+ * and cold caches. Each benchmark is run long enough to be timed reliably,
+ * a few times over, and the time per call is printed as JSON.
+ *
+ * Usage: editorconfig_microbench [--repeat N] [--min-time MS] [--filter S]
+ */
+
+#include "global.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "ec_glob.h"
+#include "ini.h"
+
+/* the number of times each benchmark is timed */
+static int          repeat_count = 7;
+/* the time a timed run should at least take */
+static uint64_t     min_time_ns = 20 * 1000 * 1000;
+
+typedef struct
+{
+    const char*     name;
+    /* called before each timed call without being timed, or NULL */
+    void            (*prepare)(void* context);
+    void            (*run)(void* context);
+    void*           context;
+    /* the bytes handled by a call, for the throughput, or 0 */
+    size_t          bytes;
+} bench_case;
+
+static uint64_t now_ns(void)
+{
+    struct timespec     ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Returns the time that iterations calls of bc took, leaving out the calls
+ * to its prepare function.
+ */
+static uint64_t time_case(const bench_case* bc, uint64_t iterations)
+{
+    uint64_t    total = 0;
+    uint64_t    start;
+    uint64_t    i;
+
+    if (bc->prepare == NULL) {
+        start = now_ns();
+        for (i = 0; i < iterations; ++i)
+            bc->run(bc->context);
+        return now_ns() - start;
+    }
+
+    for (i = 0; i < iterations; ++i) {
+        bc->prepare(bc->context);
+        start = now_ns();
+        bc->run(bc->context);
+        total += now_ns() - start;
+    }
+    return total;
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+    double      x = *(const double*)a;
+    double      y = *(const double*)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * Times bc and prints its JSON object, preceded by a comma unless it is the
+ * first one.
+ */
+static void run_case(const bench_case* bc, int first)
+{
+    uint64_t    iterations = 1;
+    uint64_t    elapsed;
+    double      per_call[64];
+    double      median;
+    int         i;
+
+    /* find how many calls take min_time_ns, which also warms up */
+    while ((elapsed = time_case(bc, iterations)) < min_time_ns &&
+            iterations < ((uint64_t)1 << 32)) {
+        uint64_t    next = elapsed > 0 ?
+            iterations * min_time_ns / elapsed + 1 : iterations * 10;
+
+        iterations = next < iterations * 10 ? next : iterations * 10;
+    }
+
+    for (i = 0; i < repeat_count; ++i)
+        per_call[i] = (double)time_case(bc, iterations) / iterations;
+    qsort(per_call, repeat_count, sizeof(double), compare_doubles);
+    median = per_call[repeat_count / 2];
+
+    printf("%s\n    {\"name\": \"%s\", \"iterations\": %llu, "
+            "\"repeats\": %d, \"ns_per_call\": {\"min\": %.1f, "
+            "\"median\": %.1f, \"max\": %.1f}",
+            first ? "" : ",", bc->name, (unsigned long long)iterations,
+            repeat_count, per_call[0], median, per_call[repeat_count - 1]);
+    if (bc->bytes > 0)
+        printf(", \"mb_per_s\": %.1f", bc->bytes * 1e3 / median);
+    printf("}");
+    fflush(stdout);
+}
+
+/* glob patterns as they come out of sections, with the directory of the
+ * .editorconfig file in front */
+typedef struct
+{
+    const char*     pattern;
+    const char*     string;
+} glob_context;
+
+static const char*  glob_kinds[] = { "star", "braces", "range" };
+
+static void glob_clear(void* context)
+{
+    (void)context;
+    ec_glob_cache_clear();
+}
+
+static void glob_run(void* context)
+{
+    glob_context*   gc = (glob_context*)context;
+
+    ec_glob(gc->pattern, gc->string, 0);
+}
+
+static glob_context glob_contexts[] =
+{
+    /* match, then no match, for each pattern */
+    { "/project/**/*.c", "/project/src/lib/ec_glob.c" },
+    { "/project/**/*.c", "/project/src/lib/ec_glob.h" },
+    { "/project/**/*.{c,h,cpp,hpp}", "/project/src/lib/ec_glob.h" },
+    { "/project/**/*.{c,h,cpp,hpp}", "/project/src/lib/Makefile" },
+    { "/project/src/{1..120}/[a-z]*.js", "/project/src/64/index.js" },
+    { "/project/src/{1..120}/[a-z]*.js", "/project/src/121/index.js" },
+};
+
+#define GLOB_PATTERN_COUNT  (sizeof(glob_kinds) / sizeof(glob_kinds[0]))
+
+/* INI data given to ini_parse_file() */
+typedef struct
+{
+    char*           data;
+    /* what the handler saw, so that the parsing is not optimized out */
+    size_t          pairs;
+} ini_context;
+
+static int ini_count_handler(void* user, const char* section,
+        const char* name, const char* value)
+{
+    (void)section;
+    (void)name;
+    (void)value;
+    ++ ((ini_context*)user)->pairs;
+    return 1;
+}
+
+static void ini_run(void* context)
+{
+    ini_context*    ic = (ini_context*)context;
+
+    ini_parse_file(ic->data, ini_count_handler, ic);
+}
+
+/*
+ * Returns INI data with section_count sections of five properties each,
+ * which must be freed.
+ */
+static char* make_ini(int section_count)
+{
+    size_t      size = 64 + (size_t)section_count * 256;
+    char*       data = (char*)malloc(size);
+    size_t      used;
+    int         i;
+
+    if (data == NULL)
+        return NULL;
+
+    used = (size_t)snprintf(data, size, "; generated\nroot = true\n\n");
+    for (i = 0; i < section_count; ++i)
+        used += (size_t)snprintf(data + used, size - used,
+                "[src/module%d/**.{c,h}]\n"
+                "indent_style = space\n"
+                "indent_size = %d\n"
+                "end_of_line = lf\n"
+                "trim_trailing_whitespace = true\n"
+                "insert_final_newline = true\n\n",
+                i, 2 + i % 3 * 2);
+    return data;
+}
+
+/* a small tree with three .editorconfig files above the resolved path */
+static char         tree_root[] = "/tmp/ec_microbench.XXXXXX";
+static char         tree_file[sizeof(tree_root) + 64];
+static const char*  tree_configs[] = { "", "/a", "/a/b/c" };
+
+static int write_file(const char* path, const char* data)
+{
+    FILE*       f = fopen(path, "w");
+
+    if (f == NULL)
+        return -1;
+    fputs(data, f);
+    return fclose(f);
+}
+
+static int make_tree(void)
+{
+    char        path[sizeof(tree_file)];
+    size_t      i;
+
+    if (mkdtemp(tree_root) == NULL)
+        return -1;
+
+    snprintf(path, sizeof(path), "%s/a", tree_root);
+    mkdir(path, 0700);
+    snprintf(path, sizeof(path), "%s/a/b", tree_root);
+    mkdir(path, 0700);
+    snprintf(path, sizeof(path), "%s/a/b/c", tree_root);
+    mkdir(path, 0700);
+
+    for (i = 0; i < sizeof(tree_configs) / sizeof(tree_configs[0]); ++i) {
+        snprintf(path, sizeof(path), "%s%s/.editorconfig", tree_root,
+                tree_configs[i]);
+        if (write_file(path, i == 0 ?
+                    "root = true\n\n[*]\nindent_style = space\n"
+                    "indent_size = 4\nend_of_line = lf\n\n"
+                    "[*.{c,h}]\nindent_size = 8\n\n[Makefile]\n"
+                    "indent_style = tab\n" :
+                    "[*.c]\ntrim_trailing_whitespace = true\n"
+                    "insert_final_newline = true\n\n[*.md]\n"
+                    "trim_trailing_whitespace = false\n"))
+            return -1;
+    }
+
+    snprintf(tree_file, sizeof(tree_file), "%s/a/b/c/file.c", tree_root);
+    return 0;
+}
+
+static void remove_tree(void)
+{
+    char        path[sizeof(tree_file)];
+    size_t      i;
+
+    for (i = 0; i < sizeof(tree_configs) / sizeof(tree_configs[0]); ++i) {
+        snprintf(path, sizeof(path), "%s%s/.editorconfig", tree_root,
+                tree_configs[i]);
+        unlink(path);
+    }
+    snprintf(path, sizeof(path), "%s/a/b/c", tree_root);
+    rmdir(path);
+    snprintf(path, sizeof(path), "%s/a/b", tree_root);
+    rmdir(path);
+    snprintf(path, sizeof(path), "%s/a", tree_root);
+    rmdir(path);
+    rmdir(tree_root);
+}
+
+/* a new handle for each cold call, as handles remember the directories
+ * they have seen */
+static void parse_clear(void* context)
+{
+    editorconfig_handle*    eh = (editorconfig_handle*)context;
+
+    editorconfig_clear_caches();
+    editorconfig_handle_destroy(*eh);
+    *eh = editorconfig_handle_init();
+}
+
+static void parse_run(void* context)
+{
+    editorconfig_parse(tree_file, *(editorconfig_handle*)context);
+}
+
+int main(int argc, const char* argv[])
+{
+    const char*         filter = NULL;
+    char                names[GLOB_PATTERN_COUNT * 3][64];
+    bench_case          cases[GLOB_PATTERN_COUNT * 3 + 4];
+    int                 case_count = 0;
+    ini_context         small_ini;
+    ini_context         huge_ini;
+    editorconfig_handle eh;
+    int                 first = 1;
+    int                 i;
+    size_t              p;
+
+    for (i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--repeat") && i + 1 < argc)
+            repeat_count = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--min-time") && i + 1 < argc)
+            min_time_ns = (uint64_t)atoi(argv[++i]) * 1000 * 1000;
+        else if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+            filter = argv[++i];
+        else {
+            fprintf(stderr, "Usage: %s [--repeat N] [--min-time MS] "
+                    "[--filter SUBSTRING]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (repeat_count < 1 || repeat_count > 64) {
+        fprintf(stderr, "--repeat must be between 1 and 64.\n");
+        return 1;
+    }
+
+    /* ec_glob(): compiling a pattern, then matching with the compiled
+     * pattern and not matching with it */
+    for (p = 0; p < GLOB_PATTERN_COUNT; ++p) {
+        static const char*  kinds[] = { "compile", "cached_match",
+            "cached_nomatch" };
+        int                 k;
+
+        for (k = 0; k < 3; ++k) {
+            snprintf(names[p * 3 + k], sizeof(names[0]), "ec_glob/%s/%s",
+                    kinds[k], glob_kinds[p]);
+            cases[case_count].name = names[p * 3 + k];
+            cases[case_count].prepare = k == 0 ? glob_clear : NULL;
+            cases[case_count].run = glob_run;
+            cases[case_count].context = &glob_contexts[p * 2 + (k == 2)];
+            cases[case_count].bytes = 0;
+            ++ case_count;
+        }
+    }
+
+    /* ini_parse_file() over a small and a huge config */
+    small_ini.data = make_ini(2);
+    huge_ini.data = make_ini(4000);
+    eh = editorconfig_handle_init();
+    if (small_ini.data == NULL || huge_ini.data == NULL || eh == NULL) {
+        perror("Unable to allocate memory");
+        return 2;
+    }
+    small_ini.pairs = huge_ini.pairs = 0;
+    cases[case_count].name = "ini_parse_file/small";
+    cases[case_count].prepare = NULL;
+    cases[case_count].run = ini_run;
+    cases[case_count].context = &small_ini;
+    cases[case_count].bytes = strlen(small_ini.data);
+    ++ case_count;
+    cases[case_count].name = "ini_parse_file/huge";
+    cases[case_count].prepare = NULL;
+    cases[case_count].run = ini_run;
+    cases[case_count].context = &huge_ini;
+    cases[case_count].bytes = strlen(huge_ini.data);
+    ++ case_count;
+
+    /* editorconfig_parse() end to end */
+    if (make_tree()) {
+        perror("Unable to create the test tree");
+        return 1;
+    }
+    cases[case_count].name = "editorconfig_parse/warm";
+    cases[case_count].prepare = NULL;
+    cases[case_count].run = parse_run;
+    cases[case_count].context = &eh;
+    cases[case_count].bytes = 0;
+    ++ case_count;
+    cases[case_count].name = "editorconfig_parse/cold";
+    cases[case_count].prepare = parse_clear;
+    cases[case_count].run = parse_run;
+    cases[case_count].context = &eh;
+    cases[case_count].bytes = 0;
+    ++ case_count;
+
+    printf("{\"benchmarks\": [");
+    for (i = 0; i < case_count; ++i) {
+        if (filter && strstr(cases[i].name, filter) == NULL)
+            continue;
+        run_case(&cases[i], first);
+        first = 0;
+    }
+    printf("\n]}\n");
+
+    editorconfig_clear_caches();
+    remove_tree();
+    editorconfig_handle_destroy(eh);
+    free(small_ini.data);
+    free(huge_ini.data);
+
+    return 0;
+}
@@ -219,6 +219,8 @@
 
 #include <editorconfig/editorconfig_handle.h>
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -260,6 +262,524 @@ extern "C" {
 EDITORCONFIG_EXPORT
 int editorconfig_parse(const char* full_filename, editorconfig_handle h);
 
+/*!
+ * @brief The type of the callback passed to editorconfig_try_parse().
+ *
+ * @param full_filename The full_filename that was passed to
+ * editorconfig_try_parse().
+ *
+ * @param err_num The value editorconfig_parse() returned when loading the
+ * files in the background. If this is not 0, calling editorconfig_try_parse()
+ * again returns the same error, as failures are cached too.
+ *
+ * @param user The user pointer that was passed to editorconfig_try_parse().
+ */
+typedef void (*editorconfig_load_callback)(const char* full_filename,
+        int err_num, void* user);
+
+/*!
+ * @brief Same as editorconfig_parse(), but only answers from the cache, so it
+ * never blocks on disk I/O or on compiling a glob pattern.
+ *
+ * If some of the editorconfig files or patterns needed are not cached, this
+ * returns EDITORCONFIG_PARSE_WOULD_BLOCK and loads them on a background
+ * queue. loaded is called on that queue when this is done, after which
+ * calling editorconfig_try_parse() again is likely to succeed. Requests for
+ * files in a directory that is already being loaded share the work.
+ *
+ * @param full_filename The full path of a file that is edited by the editor
+ * for which the parsing result is.
+ *
+ * @param h The @ref editorconfig_handle to be used and returned from this
+ * function, as with editorconfig_parse(). Its conf file name and version are
+ * also used for the background load.
+ *
+ * @param loaded If not null, called once the background load is done. Only
+ * called if EDITORCONFIG_PARSE_WOULD_BLOCK is returned.
+ *
+ * @param user Passed to loaded as is.
+ *
+ * @retval EDITORCONFIG_PARSE_WOULD_BLOCK The result is not cached yet.
+ *
+ * @return Otherwise, the same values as editorconfig_parse().
+ */
+EDITORCONFIG_EXPORT
+int editorconfig_try_parse(const char* full_filename, editorconfig_handle h,
+        editorconfig_load_callback loaded, void* user);
+
+/*!
+ * @brief The type of the callback passed to editorconfig_parse_async().
+ *
+ * @param full_filename The full_filename that was passed to
+ * editorconfig_parse_async().
+ *
+ * @param err_num The value editorconfig_parse() returned for this file.
+ *
+ * @param result A new @ref editorconfig_handle holding the parsing result,
+ * or NULL if it could not be created. The callback owns it and must destroy
+ * it with editorconfig_handle_destroy(); it is not used by the library any
+ * more, so it may be passed to any thread.
+ *
+ * @param user The user pointer that was passed to editorconfig_parse_async().
+ */
+typedef void (*editorconfig_parse_callback)(const char* full_filename,
+        int err_num, editorconfig_handle result, void* user);
+
+/*!
+ * @brief Run editorconfig_parse() on a background queue and pass the result
+ * to a callback.
+ *
+ * Finding, loading and matching the editorconfig files all happen on the
+ * library's own queues. Requests for files in the same directory that come in
+ * while one is in progress are done together, so that the editorconfig files
+ * are loaded only once.
+ *
+ * @param full_filename The full path of a file that is edited by the editor
+ * for which the parsing result is.
+ *
+ * @param options If not null, the conf file name and version of this
+ * @ref editorconfig_handle are used for the parsing. It is not used after
+ * this function returns.
+ *
+ * @param done Called on a background queue with the result. Must not be null.
+ *
+ * @param user Passed to done as is.
+ *
+ * @retval 0 The request is queued and done will be called.
+ *
+ * @retval EDITORCONFIG_PARSE_NOT_FULL_PATH The full_filename is not a full
+ * path name. done will not be called.
+ *
+ * @retval EDITORCONFIG_PARSE_VERSION_TOO_NEW The version specified in
+ * options is greater than the current version. done will not be called.
+ *
+ * @retval EDITORCONFIG_PARSE_INVALID_ARGUMENT full_filename or done is null.
+ */
+EDITORCONFIG_EXPORT
+int editorconfig_parse_async(const char* full_filename,
+        const editorconfig_handle options, editorconfig_parse_callback done,
+        void* user);
+
+/*!
+ * @brief Encode the parsing result held by h in a compact binary form.
+ *
+ * Known property names and values take one byte each, and so do small
+ * integers such as indent sizes, so a typical result takes about ten bytes.
+ * Other names and values are stored as is, unless they are in dictionary.
+ * The result can be turned back into a handle with
+ * editorconfig_result_deserialize().
+ *
+ * @param h The @ref editorconfig_handle holding the result of
+ * editorconfig_parse().
+ *
+ * @param dictionary If not null, an array of names and values that are
+ * expected to occur often, which are then stored as their index. The same
+ * dictionary, in the same order, must be used for decoding, so it is best
+ * only ever appended to.
+ *
+ * @param dictionary_size The count of strings in dictionary.
+ *
+ * @param buf Where to write the data. May be null if buf_size is 0.
+ *
+ * @param buf_size The size of buf in bytes.
+ *
+ * @return The size of the serialized result. If this is greater than
+ * buf_size, only the first buf_size bytes were written and the call should be
+ * repeated with a larger buffer.
+ */
+EDITORCONFIG_EXPORT
+size_t editorconfig_result_serialize(const editorconfig_handle h,
+        const char* const* dictionary, int dictionary_size,
+        unsigned char* buf, size_t buf_size);
+
+/*!
+ * @brief Replace the parsing result held by h with one decoded from data
+ * written by editorconfig_result_serialize().
+ *
+ * @param h The @ref editorconfig_handle that receives the result, which can
+ * then be read with editorconfig_handle_get_name_value().
+ *
+ * @param dictionary The dictionary that was used for serializing.
+ *
+ * @param dictionary_size The count of strings in dictionary.
+ *
+ * @param buf The serialized result.
+ *
+ * @param buf_size The size of the serialized result in bytes.
+ *
+ * @retval 0 Everything is OK.
+ *
+ * @retval EDITORCONFIG_PARSE_INVALID_DATA buf does not hold a serialized
+ * result, or was written with a different dictionary. h is left unchanged.
+ *
+ * @retval EDITORCONFIG_PARSE_MEMORY_ERROR A memory error occurs.
+ */
+EDITORCONFIG_EXPORT
+int editorconfig_result_deserialize(editorconfig_handle h,
+        const char* const* dictionary, int dictionary_size,
+        const unsigned char* buf, size_t buf_size);
+
+/*!
+ * @brief Counters of the caches shared by all handles, filled in by
+ * editorconfig_get_cache_stats().
+ *
+ * The hit, miss and lock counts only ever grow, take the difference of two
+ * snapshots to look at a stretch of work. Only the lookups count towards the
+ * lock statistics.
+ */
+typedef struct editorconfig_cache_stats
+{
+    /*! Reads of .editorconfig files served from memory, including files
+     * known not to exist. */
+    unsigned long long  file_hits;
+    /*! Reads of .editorconfig files that went to the disk. */
+    unsigned long long  file_misses;
+    /*! .editorconfig files currently cached. */
+    unsigned long long  file_entries;
+    /*! Glob patterns matched with an already compiled expression. */
+    unsigned long long  glob_hits;
+    /*! Glob patterns that had to be compiled. */
+    unsigned long long  glob_misses;
+    /*! Compiled glob patterns currently cached. */
+    unsigned long long  glob_entries;
+    /*! Times the lock of the .editorconfig file cache was taken. */
+    unsigned long long  file_lock_acquisitions;
+    /*! Times taking it had to wait for another thread. */
+    unsigned long long  file_lock_contended;
+    /*! Nanoseconds spent waiting for it. */
+    unsigned long long  file_lock_wait_ns;
+    /*! Times the lock of the glob pattern cache was taken. */
+    unsigned long long  glob_lock_acquisitions;
+    /*! Times taking it had to wait for another thread. */
+    unsigned long long  glob_lock_contended;
+    /*! Nanoseconds spent waiting for it. */
+    unsigned long long  glob_lock_wait_ns;
+} editorconfig_cache_stats;
+
+/*!
+ * @brief Get the counters of the caches shared by all handles.
+ *
+ * @param stats The structure to fill in.
+ *
+ * @return None.
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_get_cache_stats(editorconfig_cache_stats* stats);
+
+/*!
+ * @brief Empty the caches shared by all handles, so that the next lookups
+ * start cold. This is meant for benchmarks and tests: no editorconfig_parse()
+ * call may be running while the caches are cleared.
+ *
+ * @return None.
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_clear_caches(void);
+
+/*!
+ * @brief A compiled glob pattern in the cache, as passed to an
+ * @ref editorconfig_glob_cache_visitor.
+ */
+typedef struct editorconfig_glob_cache_entry
+{
+    /*! The glob pattern, as written in the section name. */
+    const char*         pattern;
+    /*! Bytes taken by the compiled regular expression, 0 for a pattern that
+     * does not compile, which is cached as such. */
+    unsigned long long  compiled_size;
+    /*! Times the compiled expression was reused. */
+    unsigned long long  hits;
+    /*! Nanoseconds since it was last used, or compiled if it never was. */
+    unsigned long long  idle_ns;
+} editorconfig_glob_cache_entry;
+
+/*! The cached file is not watched for changes. */
+#define EDITORCONFIG_CACHE_WATCH_NONE       0
+/*! The cached file is watched for changes. */
+#define EDITORCONFIG_CACHE_WATCH_FILE       1
+/*! The cached file does not exist, its directory is watched for it to be
+ * created. */
+#define EDITORCONFIG_CACHE_WATCH_DIRECTORY  2
+
+/*!
+ * @brief An .editorconfig file in the cache, as passed to an
+ * @ref editorconfig_file_cache_visitor.
+ */
+typedef struct editorconfig_file_cache_entry
+{
+    /*! The full path of the file. */
+    const char*         path;
+    /*! 0 if the file is cached as not existing, 1 otherwise. */
+    int                 exists;
+    /*! How the cache learns of changes to the file, one of the
+     * EDITORCONFIG_CACHE_WATCH_ values. */
+    int                 watch;
+    /*! Bytes of the contents of the file. */
+    unsigned long long  bytes;
+    /*! Sections of the file that hold properties. */
+    unsigned long long  sections;
+    /*! Properties in the file, over all sections. */
+    unsigned long long  properties;
+    /*! Times the cached contents were used. */
+    unsigned long long  hits;
+    /*! Nanoseconds since the file was cached. */
+    unsigned long long  age_ns;
+    /*! Nanoseconds since it was last used, or cached if it never was. */
+    unsigned long long  idle_ns;
+} editorconfig_file_cache_entry;
+
+/*!
+ * @brief The type of the callback passed to editorconfig_dump_caches() for
+ * glob patterns.
+ *
+ * @param entry The entry, only valid for the duration of the call.
+ *
+ * @param user The user pointer that was passed to editorconfig_dump_caches().
+ */
+typedef void (*editorconfig_glob_cache_visitor)(
+        const editorconfig_glob_cache_entry* entry, void* user);
+
+/*!
+ * @brief The type of the callback passed to editorconfig_dump_caches() for
+ * .editorconfig files.
+ *
+ * @param entry The entry, only valid for the duration of the call.
+ *
+ * @param user The user pointer that was passed to editorconfig_dump_caches().
+ */
+typedef void (*editorconfig_file_cache_visitor)(
+        const editorconfig_file_cache_entry* entry, void* user);
+
+/*!
+ * @brief List the entries of the caches shared by all handles.
+ *
+ * The visitors are called with the lock of their cache held, so lookups on
+ * other threads wait until they return, and they must not call into the
+ * library.
+ *
+ * The ages are read from a coarse clock where the system has one, so they
+ * are only precise to a few milliseconds.
+ *
+ * @param glob If not null, called for each compiled glob pattern.
+ *
+ * @param file If not null, called for each cached .editorconfig file,
+ * including those known not to exist.
+ *
+ * @param user Passed to the visitors as is.
+ *
+ * @return None.
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_dump_caches(editorconfig_glob_cache_visitor glob,
+        editorconfig_file_cache_visitor file, void* user);
+
+/*!
+ * @brief Render the metrics of the library, gathered since the process
+ * started, as Prometheus text exposition format.
+ *
+ * They cover the count of lookups, the errors by code, histograms of the
+ * time spent per lookup in each phase, and the entries, hits, misses,
+ * evictions, invalidations and lock contention of the caches.
+ *
+ * @param buf Where to write the text, which is null-terminated if len is
+ * not 0. May be null if len is 0.
+ *
+ * @param len The size of buf in bytes.
+ *
+ * @return The length of the text, not counting the terminating null. If it
+ * is not less than len, the text was cut short and the call should be
+ * repeated with a larger buffer.
+ */
+EDITORCONFIG_EXPORT
+size_t editorconfig_metrics_snapshot(char* buf, size_t len);
+
+/*!
+ * @brief Time every phase of every lookup for the histograms of
+ * editorconfig_metrics_snapshot(). Only the total time of lookups is
+ * measured by default, as reading the clock around each phase has a cost.
+ *
+ * @param enabled Nonzero to time the phases, 0 not to.
+ *
+ * @return None.
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_metrics_set_phase_timing(int enabled);
+
+/*!
+ * @brief The cost of a section of an .editorconfig file, as passed to an
+ * @ref editorconfig_profile_visitor.
+ */
+typedef struct editorconfig_profile_entry
+{
+    /*! The full path of the .editorconfig file. */
+    const char*         config_file;
+    /*! The section name, as written in the file. */
+    const char*         section;
+    /*! Times a file was matched against the section. This happens once for
+     * each property of the section. */
+    unsigned long long  attempts;
+    /*! Attempts in which the file was in the section. A section that is
+     * never matched may be dead. */
+    unsigned long long  matches;
+    /*! Nanoseconds spent matching, including compiling the pattern. */
+    unsigned long long  match_ns;
+    /*! Nanoseconds taken by the slowest attempt. */
+    unsigned long long  max_match_ns;
+} editorconfig_profile_entry;
+
+/*!
+ * @brief The type of the callback passed to editorconfig_profile_dump().
+ *
+ * @param entry The entry, only valid for the duration of the call.
+ *
+ * @param user The user pointer that was passed to
+ * editorconfig_profile_dump().
+ */
+typedef void (*editorconfig_profile_visitor)(
+        const editorconfig_profile_entry* entry, void* user);
+
+/*!
+ * @brief Attribute the time spent matching files against sections to each
+ * section of each .editorconfig file, for all lookups of the process. This is
+ * off by default, as it takes a lock on every match.
+ *
+ * @param enabled Nonzero to profile the lookups that start from now on, 0 to
+ * stop. What was gathered so far is kept.
+ *
+ * @return None.
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_profile_set_enabled(int enabled);
+
+/*!
+ * @brief List the costs gathered while profiling was enabled, costliest
+ * first.
+ *
+ * The visitor is called with the lock of the profile held, so it must not
+ * call into the library.
+ *
+ * @param visit Called for each section of each .editorconfig file that was
+ * matched against, in decreasing order of match_ns.
+ *
+ * @param user Passed to visit as is.
+ *
+ * @return None.
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_profile_dump(editorconfig_profile_visitor visit,
+        void* user);
+
+/*!
+ * @brief Forget the costs gathered so far.
+ *
+ * @return None.
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_profile_reset(void);
+
+/*!
+ * @brief A lookup that took longer than the threshold given to
+ * editorconfig_set_slow_query_callback().
+ */
+typedef struct editorconfig_slow_query
+{
+    /*! The full_filename that was passed to editorconfig_parse(). */
+    const char*                 full_filename;
+    /*! The conf files that were looked for, from the root directory down,
+     * terminated by a null pointer. Null if the lookup failed before they
+     * were found. */
+    const char* const*          config_files;
+    /*! The value editorconfig_parse() returns. */
+    int                         err_num;
+    /*! What the lookup did and how long each phase took. configs_from_disk
+     * and load_ns tell the I/O it blocked on, glob_compiles and
+     * glob_compile_ns the patterns it had to compile. */
+    editorconfig_query_stats    stats;
+} editorconfig_slow_query;
+
+/*!
+ * @brief The type of the callback passed to
+ * editorconfig_set_slow_query_callback().
+ *
+ * @param query The slow lookup, only valid for the duration of the call.
+ *
+ * @param user The user pointer that was passed to
+ * editorconfig_set_slow_query_callback().
+ */
+typedef void (*editorconfig_slow_query_callback)(
+        const editorconfig_slow_query* query, void* user);
+
+/*!
+ * @brief Have the lookups that take longer than a threshold reported to a
+ * callback, for all handles.
+ *
+ * While a callback is set, every lookup records the statistics of
+ * editorconfig_handle_set_stats_enabled(), so that slow ones can be broken
+ * down by phase. This must not be called while lookups are running.
+ *
+ * @param threshold_ns Lookups that take at least this many nanoseconds are
+ * reported.
+ *
+ * @param slow Called on the thread of the lookup, before
+ * editorconfig_parse() returns. Null to stop reporting.
+ *
+ * @param user Passed to slow as is.
+ *
+ * @return None.
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_set_slow_query_callback(unsigned long long threshold_ns,
+        editorconfig_slow_query_callback slow, void* user);
+
+/*!
+ * @brief A span of work done by a lookup, as passed to an
+ * @ref editorconfig_trace_callback.
+ */
+typedef struct editorconfig_trace_span
+{
+    /*! What was done: "query" for the whole of editorconfig_parse(), and
+     * within it "discover", "load", "parse", "glob_compile", "glob_match"
+     * and "merge". */
+    const char*         name;
+    /*! What it was done on: the path looked up for "query", "discover" and
+     * "merge", the conf file for "load" and "parse", and the glob pattern for
+     * "glob_compile" and "glob_match". */
+    const char*         subject;
+    /*! When the span began, in nanoseconds of CLOCK_MONOTONIC. */
+    unsigned long long  start_ns;
+    /*! How long it took, in nanoseconds. */
+    unsigned long long  duration_ns;
+} editorconfig_trace_span;
+
+/*!
+ * @brief The type of the callback passed to
+ * editorconfig_set_trace_callback().
+ *
+ * @param span The span, only valid for the duration of the call.
+ *
+ * @param user The user pointer that was passed to
+ * editorconfig_set_trace_callback().
+ */
+typedef void (*editorconfig_trace_callback)(
+        const editorconfig_trace_span* span, void* user);
+
+/*!
+ * @brief Pass the spans of work done by all lookups to a callback.
+ *
+ * A span is passed when it ends, on the thread that did the work, so spans
+ * nested in another one are passed before it. This must not be called while
+ * lookups are running.
+ *
+ * @param trace Called for each span. Null to stop tracing.
+ *
+ * @param user Passed to trace as is.
+ *
+ * @return None.
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_set_trace_callback(editorconfig_trace_callback trace,
+        void* user);
+
 /*!
  * @brief Get the error message from the error number returned by
  * editorconfig_parse().
@@ -289,6 +809,21 @@ const char* editorconfig_get_error_msg(int err_num);
  * editorconfig_handle is greater than the current version.
  */
 #define EDITORCONFIG_PARSE_VERSION_TOO_NEW              (-4)
+/*!
+ * editorconfig_try_parse() return value: the result is not cached yet and is
+ * being loaded in the background.
+ */
+#define EDITORCONFIG_PARSE_WOULD_BLOCK                  (-5)
+/*!
+ * editorconfig_result_deserialize() return value: the data is not a valid
+ * serialized result.
+ */
+#define EDITORCONFIG_PARSE_INVALID_DATA                 (-6)
+/*!
+ * editorconfig_parse_async() return value: a parameter is not valid, such as
+ * a null one that must not be.
+ */
+#define EDITORCONFIG_PARSE_INVALID_ARGUMENT             (-7)
 
 /*!
  * @brief Get the version number of EditorConfig.
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * @file editorconfig/editorconfig.hpp
+ * @brief C++ interface of EditorConfig.
+ *
+ * A header only wrapper of editorconfig.h and editorconfig_handle.h: ec::handle
+ * owns an @ref editorconfig_handle and exposes the parsing result as
+ * std::string_view pairs pointing into it. Nothing is allocated on top of what
+ * the C API allocates, except when an error is thrown.
+ *
+ * @author EditorConfig Team
+ */
+
+#ifndef EDITORCONFIG_EDITORCONFIG_HPP__
+#define EDITORCONFIG_EDITORCONFIG_HPP__
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <editorconfig/editorconfig.h>
+
+namespace ec {
+
+/*!
+ * @brief Thrown when editorconfig_parse() fails.
+ */
+class error : public std::runtime_error
+{
+public:
+    /*! err_num is the value returned by editorconfig_parse(). */
+    explicit error(int err_num)
+        : std::runtime_error(editorconfig_get_error_msg(err_num)),
+          err_num_(err_num) {}
+
+    /*! The value returned by editorconfig_parse(). */
+    int code() const noexcept { return err_num_; }
+
+private:
+    int err_num_;
+};
+
+/*!
+ * @brief Thrown when an EditorConfig file could not be parsed.
+ */
+class parse_error : public error
+{
+public:
+    parse_error(int line, const char* file)
+        : error(line), file_(file ? file : "") {}
+
+    /*! The line number of the parsing error. */
+    int line() const noexcept { return code(); }
+
+    /*! The EditorConfig file that caused the parsing error. */
+    const std::string& file() const noexcept { return file_; }
+
+private:
+    std::string file_;
+};
+
+/*!
+ * @brief A property name and its value. Both point into the handle they came
+ * from and are valid until it is destroyed or parses again.
+ */
+struct property
+{
+    std::string_view name;
+    std::string_view value;
+};
+
+/*!
+ * @brief A version number, as used by @ref editorconfig_handle.
+ */
+struct version
+{
+    int major;
+    int minor;
+    int patch;
+};
+
+/*!
+ * @brief Iterates over the properties of an ec::handle.
+ */
+class property_iterator
+{
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = property;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = property;
+
+    property_iterator() noexcept = default;
+    property_iterator(editorconfig_handle h, int n) noexcept
+        : handle_(h), n_(n) {}
+
+    property operator*() const noexcept
+    {
+        const char* name;
+        const char* value;
+
+        editorconfig_handle_get_name_value(handle_, n_, &name, &value);
+        return { name, value };
+    }
+
+    property_iterator& operator++() noexcept { ++n_; return *this; }
+    property_iterator operator++(int) noexcept
+    {
+        property_iterator tmp = *this;
+        ++n_;
+        return tmp;
+    }
+
+    bool operator==(const property_iterator& other) const noexcept
+    {
+        return n_ == other.n_;
+    }
+    bool operator!=(const property_iterator& other) const noexcept
+    {
+        return n_ != other.n_;
+    }
+
+private:
+    editorconfig_handle handle_ = nullptr;
+    int                 n_ = 0;
+};
+
+/*!
+ * @brief Owns an @ref editorconfig_handle. Can only be moved.
+ *
+ * @code
+ * ec::handle h;
+ * h.parse("/full/path/to/file.c");
+ * for (ec::property p : h)
+ *     std::cout << p.name << '=' << p.value << '\n';
+ * if (auto style = h.value("indent_style"))
+ *     use(*style);
+ * @endcode
+ */
+class handle
+{
+public:
+    /*! Create a new handle. Throws std::bad_alloc if that fails. */
+    handle() : handle_(editorconfig_handle_init())
+    {
+        if (!handle_)
+            throw std::bad_alloc();
+    }
+
+    /*! Take ownership of h, which may be null. */
+    explicit handle(editorconfig_handle h) noexcept : handle_(h) {}
+
+    handle(handle&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    handle& operator=(handle&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    handle(const handle&) = delete;
+    handle& operator=(const handle&) = delete;
+
+    ~handle() { reset(); }
+
+    /*! The underlying handle, still owned by this object. */
+    editorconfig_handle get() const noexcept { return handle_; }
+
+    /*! Give up ownership of the underlying handle. */
+    editorconfig_handle release() noexcept
+    {
+        return std::exchange(handle_, nullptr);
+    }
+
+    /*! False if this doesn't own a handle, e.g. after being moved from. */
+    explicit operator bool() const noexcept { return handle_ != nullptr; }
+
+    /*! See editorconfig_handle_set_conf_file_name(). conf_file_name is not
+     * copied and must outlive its use. */
+    void set_conf_file_name(const char* conf_file_name) noexcept
+    {
+        editorconfig_handle_set_conf_file_name(handle_, conf_file_name);
+    }
+
+    /*! See editorconfig_handle_get_conf_file_name(). */
+    const char* conf_file_name() const noexcept
+    {
+        return editorconfig_handle_get_conf_file_name(handle_);
+    }
+
+    /*! See editorconfig_handle_set_version(). */
+    void set_version(int major, int minor, int patch) noexcept
+    {
+        editorconfig_handle_set_version(handle_, major, minor, patch);
+    }
+
+    /*! See editorconfig_handle_get_version(). */
+    ec::version version() const noexcept
+    {
+        ec::version v;
+
+        editorconfig_handle_get_version(handle_, &v.major, &v.minor, &v.patch);
+        return v;
+    }
+
+    /*! See editorconfig_handle_get_err_file(). */
+    const char* err_file() const noexcept
+    {
+        return editorconfig_handle_get_err_file(handle_);
+    }
+
+    /*!
+     * Parse the EditorConfig files for full_filename, replacing the previous
+     * result. Throws ec::parse_error if an EditorConfig file is invalid and
+     * ec::error for any other error.
+     */
+    void parse(const char* full_filename)
+    {
+        int err_num = editorconfig_parse(full_filename, handle_);
+
+        if (err_num > 0)
+            throw parse_error(err_num, err_file());
+        if (err_num < 0)
+            throw error(err_num);
+    }
+
+    /*! Same as parse(const char*). */
+    void parse(const std::string& full_filename)
+    {
+        parse(full_filename.c_str());
+    }
+
+    /*! The number of properties. */
+    int size() const noexcept
+    {
+        return handle_ ? editorconfig_handle_get_name_value_count(handle_) : 0;
+    }
+
+    /*! True if there are no properties. */
+    bool empty() const noexcept { return size() == 0; }
+
+    property_iterator begin() const noexcept
+    {
+        return property_iterator(handle_, 0);
+    }
+
+    property_iterator end() const noexcept
+    {
+        return property_iterator(handle_, size());
+    }
+
+    /*! The nth property. */
+    property operator[](int n) const noexcept
+    {
+        return *property_iterator(handle_, n);
+    }
+
+    /*! The property called name, or end() if there is none. */
+    property_iterator find(std::string_view name) const noexcept
+    {
+        property_iterator it = begin();
+        property_iterator last = end();
+
+        for (; it != last; ++it)
+            if ((*it).name == name)
+                break;
+        return it;
+    }
+
+    /*! The value of the property called name, if there is one. */
+    std::optional<std::string_view> value(std::string_view name) const noexcept
+    {
+        property_iterator it = find(name);
+
+        if (it == end())
+            return std::nullopt;
+        return (*it).value;
+    }
+
+private:
+    void reset() noexcept
+    {
+        if (handle_)
+            editorconfig_handle_destroy(std::exchange(handle_, nullptr));
+    }
+
+    editorconfig_handle handle_;
+};
+
+} /* namespace ec */
+
+#endif /* !EDITORCONFIG_EDITORCONFIG_HPP__ */
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * @file editorconfig/editorconfig_coro.hpp
+ * @brief C++20 coroutine interface of EditorConfig.
+ *
+ * Wraps editorconfig_parse_async() so that a coroutine can wait for the
+ * result with co_await ec::resolve(path).
+ *
+ * @author EditorConfig Team
+ */
+
+#ifndef EDITORCONFIG_EDITORCONFIG_CORO_HPP__
+#define EDITORCONFIG_EDITORCONFIG_CORO_HPP__
+
+#include <coroutine>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <editorconfig/editorconfig.hpp>
+
+namespace ec {
+
+/*!
+ * @brief The result of ec::resolve(): an ec::handle holding the properties,
+ * plus the value editorconfig_parse() returned.
+ *
+ * Owns the @ref editorconfig_handle the library created for the result, so it
+ * can only be moved. Names and values are views into the handle and are valid
+ * as long as the result is.
+ */
+class result : public handle
+{
+public:
+    result() noexcept : handle(nullptr) {}
+
+    /*! Take ownership of h, which holds the result of a parse returning
+     * err_num. */
+    result(editorconfig_handle h, int err_num) noexcept
+        : handle(h), err_num_(err_num) {}
+
+    /*! The value editorconfig_parse() returned. */
+    int error() const noexcept { return err_num_; }
+
+    /*! The message for error(). */
+    const char* error_message() const noexcept
+    {
+        return editorconfig_get_error_msg(err_num_);
+    }
+
+    /*! True if the parse succeeded. */
+    explicit operator bool() const noexcept
+    {
+        return err_num_ == 0 && get() != nullptr;
+    }
+
+private:
+    int err_num_ = 0;
+};
+
+/*!
+ * @brief Options for ec::resolve(), the same as the settings of an
+ * @ref editorconfig_handle.
+ */
+struct options
+{
+    /*! The conf file name, or nullptr for ".editorconfig". Must stay valid
+     * until ec::resolve() is awaited. */
+    const char* conf_file_name = nullptr;
+    /*! The version to act as; negative fields are left at the default. */
+    int         version_major = -1;
+    int         version_minor = -1;
+    int         version_patch = -1;
+};
+
+/*!
+ * @brief The default executor: resume the coroutine right away, on the
+ * library's queue that finished the work.
+ *
+ * An executor is any callable taking a std::coroutine_handle<> and arranging
+ * for it to be resumed, such as posting it to an event loop.
+ */
+struct inline_executor
+{
+    void operator()(std::coroutine_handle<> h) const { h.resume(); }
+};
+
+/*!
+ * @brief The awaitable returned by ec::resolve().
+ */
+template <class Executor = inline_executor>
+class resolve_awaitable
+{
+public:
+    resolve_awaitable(std::string_view path, const options& opts,
+            Executor executor)
+        : path_(path), options_(opts), executor_(std::move(executor)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> h)
+    {
+        editorconfig_handle opts = nullptr;
+        int                 err_num;
+
+        coroutine_ = h;
+
+        if (options_.conf_file_name || options_.version_major >= 0 ||
+                options_.version_minor >= 0 || options_.version_patch >= 0) {
+            opts = editorconfig_handle_init();
+            if (!opts) {
+                result_ = result(nullptr, EDITORCONFIG_PARSE_MEMORY_ERROR);
+                return false;
+            }
+            editorconfig_handle_set_conf_file_name(opts,
+                    options_.conf_file_name);
+            editorconfig_handle_set_version(opts, options_.version_major,
+                    options_.version_minor, options_.version_patch);
+        }
+
+        /* done() may run on another thread before this returns, so nothing
+         * in *this may be touched once the request is queued */
+        err_num = editorconfig_parse_async(path_.c_str(), opts, &done, this);
+        editorconfig_handle_destroy(opts);
+
+        if (err_num != 0) {
+            result_ = result(nullptr, err_num);
+            return false;   /* resume right away */
+        }
+
+        return true;
+    }
+
+    result await_resume() noexcept { return std::move(result_); }
+
+private:
+    static void done(const char*, int err_num, editorconfig_handle h,
+            void* user)
+    {
+        auto*                   self = static_cast<resolve_awaitable*>(user);
+        std::coroutine_handle<> coroutine = self->coroutine_;
+        /* resuming may destroy *self, so don't call through it */
+        Executor                executor(std::move(self->executor_));
+
+        self->result_ = result(h, err_num);
+        executor(coroutine);
+    }
+
+    std::string             path_;
+    options                 options_;
+    Executor                executor_;
+    std::coroutine_handle<> coroutine_;
+    result                  result_;
+};
+
+/*!
+ * @brief Resolve the EditorConfig properties of the file at path without
+ * blocking: co_await ec::resolve(path) suspends the coroutine until the
+ * result is available and then evaluates to an ec::result.
+ *
+ * @param path The full path of the file.
+ *
+ * @param opts The conf file name and version to use.
+ *
+ * @param executor Called to resume the coroutine when the result is ready.
+ */
+template <class Executor = inline_executor>
+resolve_awaitable<Executor> resolve(std::string_view path,
+        const options& opts = {}, Executor executor = {})
+{
+    return resolve_awaitable<Executor>(path, opts, std::move(executor));
+}
+
+} /* namespace ec */
+
+#endif /* !EDITORCONFIG_EDITORCONFIG_CORO_HPP__ */
@@ -185,6 +185,100 @@ void editorconfig_handle_get_name_value(const editorconfig_handle h, int n,
 EDITORCONFIG_EXPORT
 int editorconfig_handle_get_name_value_count(const editorconfig_handle h);
 
+/*!
+ * @brief Get a hash of the names and values held by an editorconfig_handle
+ * object.
+ *
+ * Handles holding the same names and values in the same order have the same
+ * fingerprint, so it can be used to group identical results without looking
+ * at the strings. Different results may have the same fingerprint too, if
+ * rarely.
+ *
+ * @param h The editorconfig_handle object whose fingerprint needs to be
+ * obtained.
+ *
+ * @return The 64-bit fingerprint of the result held by h.
+ */
+EDITORCONFIG_EXPORT
+unsigned long long editorconfig_handle_get_fingerprint(
+        const editorconfig_handle h);
+
+/*!
+ * @brief What the last editorconfig_parse() call on a handle did and how
+ * long each part took, see editorconfig_handle_get_stats().
+ *
+ * The times of the phases are nested: parse_ns includes glob_compile_ns and
+ * glob_match_ns, since globs are matched as the files are parsed, and all
+ * of them are included in total_ns.
+ */
+typedef struct editorconfig_query_stats
+{
+    /*! Directories where a conf file was looked for. */
+    unsigned long long  ancestors;
+    /*! Conf files read from the disk, or found missing there. */
+    unsigned long long  configs_from_disk;
+    /*! Conf files, or their absence, taken from the cache. */
+    unsigned long long  configs_from_cache;
+    /*! Bytes of conf files parsed. */
+    unsigned long long  bytes_parsed;
+    /*! Section headers parsed. */
+    unsigned long long  sections;
+    /*! Glob patterns compiled. */
+    unsigned long long  glob_compiles;
+    /*! Glob patterns found compiled in the cache. */
+    unsigned long long  glob_cache_hits;
+    /*! Glob patterns not found in the cache. */
+    unsigned long long  glob_cache_misses;
+    /*! Paths matched against a compiled glob pattern. */
+    unsigned long long  glob_matches;
+    /*! Nanoseconds spent finding the conf files that apply. */
+    unsigned long long  discover_ns;
+    /*! Nanoseconds spent reading conf files from the disk. */
+    unsigned long long  load_ns;
+    /*! Nanoseconds spent parsing conf files. */
+    unsigned long long  parse_ns;
+    /*! Nanoseconds spent compiling glob patterns. */
+    unsigned long long  glob_compile_ns;
+    /*! Nanoseconds spent matching glob patterns. */
+    unsigned long long  glob_match_ns;
+    /*! Nanoseconds spent merging the values found into the result. */
+    unsigned long long  merge_ns;
+    /*! Nanoseconds spent in editorconfig_parse() as a whole. */
+    unsigned long long  total_ns;
+} editorconfig_query_stats;
+
+/*!
+ * @brief Turn the recording of statistics on or off for the following
+ * editorconfig_parse() calls on a handle. It is off by default, as reading
+ * the clock for every phase has a cost.
+ *
+ * @param h The editorconfig_handle object.
+ *
+ * @param enabled Nonzero to record statistics, 0 not to.
+ *
+ * @return None.
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_handle_set_stats_enabled(editorconfig_handle h,
+        int enabled);
+
+/*!
+ * @brief Get the statistics of the last editorconfig_parse() call on a
+ * handle, see editorconfig_handle_set_stats_enabled().
+ *
+ * @param h The editorconfig_handle object.
+ *
+ * @param stats The structure to fill in.
+ *
+ * @retval 0 stats is filled in.
+ *
+ * @retval -1 Statistics are not enabled on h, or it has not been used for
+ * parsing since they were. stats is left unchanged.
+ */
+EDITORCONFIG_EXPORT
+int editorconfig_handle_get_stats(const editorconfig_handle h,
+        editorconfig_query_stats* stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <editorconfig/editorconfig.h>
+
+#include "bench.h"
+
+/*
+ * See header file
+ */
+int bench_workload_init(bench_workload* workload)
+{
+    workload->data_size = 64 * 1024;
+    workload->data_used = 0;
+    workload->data = (char*)malloc(workload->data_size);
+    workload->capacity = 1024;
+    workload->count = 0;
+    workload->offsets = (size_t*)malloc(workload->capacity * sizeof(size_t));
+
+    return workload->data && workload->offsets ? 0 : -1;
+}
+
+/*
+ * See header file
+ */
+void bench_workload_free(bench_workload* workload)
+{
+    free(workload->data);
+    free(workload->offsets);
+    workload->data = NULL;
+    workload->offsets = NULL;
+}
+
+/*
+ * See header file
+ */
+int bench_workload_add(bench_workload* workload, const char* path,
+        size_t len)
+{
+    if (workload->count == workload->capacity) {
+        size_t*     offsets = (size_t*)realloc(workload->offsets,
+                workload->capacity * 2 * sizeof(size_t));
+
+        if (offsets == NULL)
+            return -1;
+        workload->offsets = offsets;
+        workload->capacity *= 2;
+    }
+
+    if (workload->data_size - workload->data_used < len + 1) {
+        size_t      size = workload->data_size * 2;
+        char*       data;
+
+        while (size - workload->data_used < len + 1)
+            size *= 2;
+        data = (char*)realloc(workload->data, size);
+        if (data == NULL)
+            return -1;
+        workload->data = data;
+        workload->data_size = size;
+    }
+
+    memcpy(workload->data + workload->data_used, path, len);
+    workload->data[workload->data_used + len] = '\0';
+    workload->offsets[workload->count++] = workload->data_used;
+    workload->data_used += len + 1;
+
+    return 0;
+}
+
+/* one pass over the workload, shared by its threads */
+typedef struct
+{
+    const bench_workload*   workload;
+    const bench_options*    options;
+    /* the index of the next path to resolve, taken by the threads in turn */
+    size_t                  next;
+    /* the time each path took, in nanoseconds */
+    uint64_t*               latencies;
+    size_t                  errors;
+    /* set if a thread could not create its handle */
+    int                     failed;
+} bench_pass;
+
+static uint64_t now_ns(void)
+{
+    struct timespec     ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void* bench_thread(void* context)
+{
+    bench_pass*             pass = (bench_pass*)context;
+    const bench_workload*   workload = pass->workload;
+    editorconfig_handle     eh = editorconfig_handle_init();
+    size_t                  i;
+
+    if (eh == NULL) {
+        __atomic_store_n(&pass->failed, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    if (pass->options->conf_filename)
+        editorconfig_handle_set_conf_file_name(eh,
+                pass->options->conf_filename);
+    editorconfig_handle_set_version(eh, pass->options->version_major,
+            pass->options->version_minor, pass->options->version_patch);
+
+    while ((i = __atomic_fetch_add(&pass->next, 1, __ATOMIC_RELAXED)) <
+            workload->count) {
+        uint64_t    start = now_ns();
+        int         err_num;
+
+        err_num = editorconfig_parse(workload->data + workload->offsets[i],
+                eh);
+        pass->latencies[i] = now_ns() - start;
+        if (err_num != 0)
+            __atomic_fetch_add(&pass->errors, 1, __ATOMIC_RELAXED);
+    }
+
+    editorconfig_handle_destroy(eh);
+    return NULL;
+}
+
+static int compare_latencies(const void* a, const void* b)
+{
+    uint64_t    x = *(const uint64_t*)a;
+    uint64_t    y = *(const uint64_t*)b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * The latency that a fraction of the sorted latencies are not above.
+ */
+static uint64_t percentile(const uint64_t* sorted, size_t count,
+        double fraction)
+{
+    size_t      rank = (size_t)(fraction * count + 0.999999);
+
+    if (count == 0)
+        return 0;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static int bench_printf(output_buffer* out, const char* format, ...)
+{
+    char        line[512];
+    va_list     args;
+    int         len;
+
+    va_start(args, format);
+    len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (len < 0 || (size_t)len >= sizeof(line))
+        return -1;
+
+    return output_write(out, line, (size_t)len);
+}
+
+static double hit_rate(unsigned long long hits, unsigned long long misses)
+{
+    return hits + misses > 0 ? (double)hits / (hits + misses) : 0;
+}
+
+/*
+ * Runs one pass with thread_count threads and prints its JSON object.
+ */
+static int bench_pass_run(const bench_workload* workload,
+        const bench_options* options, int thread_count, const char* cache,
+        uint64_t* latencies, pthread_t* threads, output_buffer* out)
+{
+    bench_pass                  pass;
+    editorconfig_cache_stats    before;
+    editorconfig_cache_stats    after;
+    uint64_t                    start;
+    double                      seconds;
+    int                         started;
+    int                         joined;
+    size_t                      n = workload->count;
+
+    memset(&pass, 0, sizeof(pass));
+    pass.workload = workload;
+    pass.options = options;
+    pass.latencies = latencies;
+
+    editorconfig_get_cache_stats(&before);
+    start = now_ns();
+    for (started = 0; started < thread_count; ++started)
+        if (pthread_create(&threads[started], NULL, bench_thread, &pass))
+            break;
+    for (joined = 0; joined < started; ++joined)
+        pthread_join(threads[joined], NULL);
+    seconds = (now_ns() - start) / 1e9;
+    editorconfig_get_cache_stats(&after);
+
+    if (pass.failed || started < thread_count)
+        return -1;
+
+    qsort(latencies, n, sizeof(uint64_t), compare_latencies);
+
+    return bench_printf(out,
+            "    {\"threads\": %d, \"cache\": \"%s\", \"queries\": %zu, "
+            "\"errors\": %zu, \"seconds\": %.6f, "
+            "\"queries_per_second\": %.1f,\n", thread_count, cache, n,
+            pass.errors, seconds, seconds > 0 ? n / seconds : 0) ||
+        bench_printf(out,
+            "     \"latency_ns\": {\"min\": %llu, \"p50\": %llu, "
+            "\"p99\": %llu, \"p999\": %llu, \"max\": %llu},\n",
+            (unsigned long long)(n ? latencies[0] : 0),
+            (unsigned long long)percentile(latencies, n, 0.5),
+            (unsigned long long)percentile(latencies, n, 0.99),
+            (unsigned long long)percentile(latencies, n, 0.999),
+            (unsigned long long)(n ? latencies[n - 1] : 0)) ||
+        bench_printf(out,
+            "     \"file_cache\": {\"hits\": %llu, \"misses\": %llu, "
+            "\"hit_rate\": %.4f, \"lock_acquisitions\": %llu, "
+            "\"lock_contended\": %llu, \"lock_wait_ns\": %llu},\n",
+            after.file_hits - before.file_hits,
+            after.file_misses - before.file_misses,
+            hit_rate(after.file_hits - before.file_hits,
+                after.file_misses - before.file_misses),
+            after.file_lock_acquisitions - before.file_lock_acquisitions,
+            after.file_lock_contended - before.file_lock_contended,
+            after.file_lock_wait_ns - before.file_lock_wait_ns) ||
+        bench_printf(out,
+            "     \"glob_cache\": {\"hits\": %llu, \"misses\": %llu, "
+            "\"hit_rate\": %.4f, \"lock_acquisitions\": %llu, "
+            "\"lock_contended\": %llu, \"lock_wait_ns\": %llu}}",
+            after.glob_hits - before.glob_hits,
+            after.glob_misses - before.glob_misses,
+            hit_rate(after.glob_hits - before.glob_hits,
+                after.glob_misses - before.glob_misses),
+            after.glob_lock_acquisitions - before.glob_lock_acquisitions,
+            after.glob_lock_contended - before.glob_lock_contended,
+            after.glob_lock_wait_ns - before.glob_lock_wait_ns);
+}
+
+/*
+ * See header file
+ */
+int bench_run(const bench_workload* workload, const bench_options* options,
+        output_buffer* out)
+{
+    uint64_t*   latencies;
+    pthread_t*  threads;
+    int         max_threads = 1;
+    int         err = 0;
+    int         i;
+
+    for (i = 0; i < options->run_count; ++i)
+        if (options->thread_counts[i] > max_threads)
+            max_threads = options->thread_counts[i];
+
+    latencies = (uint64_t*)malloc((workload->count + 1) * sizeof(uint64_t));
+    threads = (pthread_t*)malloc(max_threads * sizeof(pthread_t));
+    if (latencies == NULL || threads == NULL) {
+        free(latencies);
+        free(threads);
+        return -1;
+    }
+
+    err = bench_printf(out, "{\"paths\": %zu, \"runs\": [\n",
+            workload->count);
+    for (i = 0; err == 0 && i < options->run_count; ++i) {
+        const char*     separator = i + 1 < options->run_count ? ",\n" : "\n";
+
+        /* start from what a new process would see */
+        editorconfig_clear_caches();
+        err = bench_pass_run(workload, options, options->thread_counts[i],
+                    "cold", latencies, threads, out) ||
+            output_write(out, ",\n", 2) ||
+            bench_pass_run(workload, options, options->thread_counts[i],
+                    "warm", latencies, threads, out) ||
+            output_write(out, separator, strlen(separator));
+    }
+    if (err == 0)
+        err = output_write(out, "]}\n", 3);
+
+    free(latencies);
+    free(threads);
+    return err ? -1 : 0;
+}
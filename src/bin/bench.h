@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * A benchmark built into the command line tool: the paths of a workload are
+ * resolved once with empty caches and once more with warm ones, for each of
+ * the given thread counts, and the timings and cache counters of every pass
+ * are printed as JSON.
+ */
+
+#ifndef BENCH_H__
+#define BENCH_H__
+
+#include <stddef.h>
+
+#include "output.h"
+
+/* the paths to resolve, kept so that they can be resolved any number of
+ * times */
+typedef struct
+{
+    /* the paths one after another, each NUL-terminated */
+    char*       data;
+    size_t      data_size;
+    size_t      data_used;
+    /* where each path starts in data */
+    size_t*     offsets;
+    size_t      count;
+    size_t      capacity;
+} bench_workload;
+
+typedef struct
+{
+    /* the options of the handles, as given with -f and -b */
+    const char* conf_filename;
+    int         version_major;
+    int         version_minor;
+    int         version_patch;
+    /* a cold and a warm pass are run with each of these thread counts */
+    const int*  thread_counts;
+    int         run_count;
+} bench_options;
+
+/*
+ * Set up an empty workload. Returns 0 if successful, -1 if out of memory.
+ */
+int bench_workload_init(bench_workload* workload);
+
+void bench_workload_free(bench_workload* workload);
+
+/*
+ * Append a copy of the first len characters of path. Returns 0 if
+ * successful, -1 if out of memory.
+ */
+int bench_workload_add(bench_workload* workload, const char* path,
+        size_t len);
+
+/*
+ * Run the passes and print the report to out. Paths that fail to resolve are
+ * counted, not reported. Returns 0 if successful, -1 if out of memory, if a
+ * thread cannot be started or on a write error.
+ */
+int bench_run(const bench_workload* workload, const bench_options* options,
+        output_buffer* out);
+
+#endif /* !BENCH_H__ */
@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "daemon.h"
+
+/* requests are a path and a conf file name, anything longer is bogus */
+#define MAX_REQUEST_SIZE        (64 * 1024)
+
+/* the socket path, so that it can be removed on SIGTERM */
+static const char*      _socket_path;
+
+/* the count of connected clients and when the last one went away */
+static pthread_mutex_t  _clients_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int              _client_count;
+static time_t           _last_activity;
+
+static uint32_t get_u32(const unsigned char* p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 |
+        (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void put_u32(unsigned char* p, uint32_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+}
+
+/*
+ * read() or write() all of len bytes. Returns -1 on an error or at the end
+ * of the stream.
+ */
+static int read_full(int fd, unsigned char* buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t     n = read(fd, buf, len);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        buf += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+static int write_full(int fd, const unsigned char* buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t     n = write(fd, buf, len);
+
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return -1;
+        buf += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+/*
+ * Makes sure buf holds at least size bytes. Returns -1 if out of memory.
+ */
+static int reserve(unsigned char** buf, size_t* buf_size, size_t size)
+{
+    unsigned char*  new_buf;
+
+    if (*buf_size >= size)
+        return 0;
+
+    new_buf = (unsigned char*)realloc(*buf, size);
+    if (new_buf == NULL)
+        return -1;
+    *buf = new_buf;
+    *buf_size = size;
+
+    return 0;
+}
+
+static void set_socket_address(struct sockaddr_un* addr, const char* path)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strncpy(addr->sun_path, path, sizeof(addr->sun_path) - 1);
+}
+
+/*
+ * Returns 0 if the process at the other end of fd runs as the same user as
+ * this one. The daemon answers with what it can read, and the client trusts
+ * the answers, so neither talks to other users.
+ */
+static int check_peer(int fd)
+{
+    uid_t           uid;
+#if defined(HAVE_GETPEEREID)
+    gid_t           gid;
+
+    if (getpeereid(fd, &uid, &gid))
+        return -1;
+#elif defined(SO_PEERCRED)
+    struct ucred    cred;
+    socklen_t       len = sizeof(cred);
+
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len))
+        return -1;
+    uid = cred.uid;
+#else
+    /* no way to tell, the mode of the socket file has to do */
+    (void)fd;
+    uid = geteuid();
+#endif
+
+    return uid == geteuid() ? 0 : -1;
+}
+
+/*
+ * Answers the requests of one client until it disconnects.
+ */
+static void* serve_client(void* arg)
+{
+    int                 fd = (int)(intptr_t)arg;
+    editorconfig_handle eh = editorconfig_handle_init();
+    unsigned char*      request = (unsigned char*)malloc(MAX_REQUEST_SIZE + 1);
+    unsigned char*      response = NULL;
+    size_t              response_size = 0;
+
+    while (eh && request) {
+        unsigned char   header[4];
+        uint32_t        len;
+        const char*     conf;
+        const char*     full_filename;
+        size_t          result_len;
+        int             err_num;
+
+        if (read_full(fd, header, 4))
+            break;
+        len = get_u32(header);
+        if (len < 4 || len > MAX_REQUEST_SIZE || read_full(fd, request, len))
+            break;
+        request[len] = '\0';
+
+        conf = (const char*)request + 3;
+        full_filename = conf + strlen(conf) + 1;
+        if ((const unsigned char*)full_filename > request + len)
+            break;
+
+        editorconfig_handle_set_conf_file_name(eh, *conf ? conf : NULL);
+        editorconfig_handle_set_version(eh, request[0], request[1],
+                request[2]);
+        err_num = editorconfig_parse(full_filename, eh);
+
+        result_len = err_num == 0 ?
+            editorconfig_result_serialize(eh, NULL, 0, NULL, 0) : 0;
+        if (reserve(&response, &response_size, 8 + result_len))
+            break;
+        put_u32(response, (uint32_t)(4 + result_len));
+        put_u32(response + 4, (uint32_t)err_num);
+        if (err_num == 0)
+            editorconfig_result_serialize(eh, NULL, 0, response + 8,
+                    result_len);
+
+        if (write_full(fd, response, 8 + result_len))
+            break;
+    }
+
+    close(fd);
+    editorconfig_handle_destroy(eh);
+    free(request);
+    free(response);
+
+    pthread_mutex_lock(&_clients_mutex);
+    -- _client_count;
+    _last_activity = time(NULL);
+    pthread_mutex_unlock(&_clients_mutex);
+
+    return NULL;
+}
+
+static void remove_socket(int sig)
+{
+    unlink(_socket_path);
+    _exit(128 + sig);
+}
+
+/*
+ * See header file
+ */
+int daemon_serve(const char* socket_path, int idle_timeout)
+{
+    struct sockaddr_un  addr;
+    int                 listen_fd;
+    daemon_client       other;
+    mode_t              old_umask;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path is too long: %s\n", socket_path);
+        return 1;
+    }
+
+    /* a socket file without a daemon behind it is left over from a daemon
+     * that was killed, take its place */
+    if (daemon_client_connect(&other, socket_path) == 0) {
+        daemon_client_close(&other);
+        fprintf(stderr, "A daemon is already listening on %s\n", socket_path);
+        return 1;
+    }
+    unlink(socket_path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    set_socket_address(&addr, socket_path);
+    /* only our own user may connect, the socket file is created 0600 */
+    old_umask = umask(0177);
+    if (listen_fd < 0 ||
+            bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) ||
+            listen(listen_fd, SOMAXCONN)) {
+        perror(socket_path);
+        umask(old_umask);
+        return 1;
+    }
+    umask(old_umask);
+
+    _socket_path = socket_path;
+    signal(SIGTERM, remove_socket);
+    signal(SIGINT, remove_socket);
+    /* a client going away while being answered must not kill the daemon */
+    signal(SIGPIPE, SIG_IGN);
+
+    _last_activity = time(NULL);
+
+    for (;;) {
+        struct pollfd   pfd;
+        int             ready;
+
+        pfd.fd = listen_fd;
+        pfd.events = POLLIN;
+        ready = poll(&pfd, 1, 1000);
+
+        if (ready > 0) {
+            int         fd = accept(listen_fd, NULL, NULL);
+            pthread_t   thread;
+
+            if (fd < 0)
+                continue;
+            if (check_peer(fd)) {
+                close(fd);
+                continue;
+            }
+
+            pthread_mutex_lock(&_clients_mutex);
+            ++ _client_count;
+            pthread_mutex_unlock(&_clients_mutex);
+
+            if (pthread_create(&thread, NULL, serve_client,
+                        (void*)(intptr_t)fd)) {
+                close(fd);
+                pthread_mutex_lock(&_clients_mutex);
+                -- _client_count;
+                pthread_mutex_unlock(&_clients_mutex);
+                continue;
+            }
+            pthread_detach(thread);
+        } else if (ready < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        } else if (idle_timeout > 0) {
+            _Bool       idle;
+
+            pthread_mutex_lock(&_clients_mutex);
+            idle = _client_count == 0 &&
+                time(NULL) - _last_activity >= idle_timeout;
+            pthread_mutex_unlock(&_clients_mutex);
+
+            if (idle)
+                break;
+        }
+    }
+
+    close(listen_fd);
+    unlink(socket_path);
+
+    return 0;
+}
+
+/*
+ * See header file
+ */
+int daemon_client_connect(daemon_client* client, const char* socket_path)
+{
+    struct sockaddr_un  addr;
+
+    client->buf = NULL;
+    client->size = 0;
+
+    if (strlen(socket_path) >= sizeof(addr.sun_path))
+        return client->fd = -1;
+
+    client->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client->fd < 0)
+        return -1;
+
+    set_socket_address(&addr, socket_path);
+    /* a daemon of another user could give made up answers */
+    if (connect(client->fd, (struct sockaddr*)&addr, sizeof(addr)) ||
+            check_peer(client->fd)) {
+        close(client->fd);
+        return client->fd = -1;
+    }
+
+    return 0;
+}
+
+/*
+ * See header file
+ */
+void daemon_client_close(daemon_client* client)
+{
+    if (client->fd >= 0)
+        close(client->fd);
+    client->fd = -1;
+    free(client->buf);
+    client->buf = NULL;
+    client->size = 0;
+}
+
+/*
+ * See header file
+ */
+int daemon_client_parse(daemon_client* client, const char* full_filename,
+        editorconfig_handle eh)
+{
+    const char*     conf = editorconfig_handle_get_conf_file_name(eh);
+    size_t          conf_len = conf ? strlen(conf) : 0;
+    size_t          path_len = strlen(full_filename);
+    size_t          len = 3 + conf_len + 1 + path_len;
+    int             major;
+    int             minor;
+    int             patch;
+    unsigned char*  p;
+    int             err_num;
+
+    if (client->fd < 0)
+        return DAEMON_UNAVAILABLE;
+
+    editorconfig_handle_get_version(eh, &major, &minor, &patch);
+
+    if (len > MAX_REQUEST_SIZE ||
+            reserve(&client->buf, &client->size, 4 + len))
+        return DAEMON_UNAVAILABLE;
+
+    p = client->buf;
+    put_u32(p, (uint32_t)len);
+    p[4] = major > 255 ? 255 : (unsigned char)major;
+    p[5] = minor > 255 ? 255 : (unsigned char)minor;
+    p[6] = patch > 255 ? 255 : (unsigned char)patch;
+    p += 7;
+    if (conf_len)
+        memcpy(p, conf, conf_len);
+    p[conf_len] = '\0';
+    memcpy(p + conf_len + 1, full_filename, path_len);
+
+    if (write_full(client->fd, client->buf, 4 + len) ||
+            read_full(client->fd, client->buf, 4))
+        goto unavailable;
+
+    len = get_u32(client->buf);
+    if (len < 4 || reserve(&client->buf, &client->size, len) ||
+            read_full(client->fd, client->buf, len))
+        goto unavailable;
+
+    err_num = (int)get_u32(client->buf);
+    if (err_num == 0)
+        err_num = editorconfig_result_deserialize(eh, NULL, 0,
+                client->buf + 4, len - 4);
+
+    return err_num;
+
+ unavailable:
+    daemon_client_close(client);
+    return DAEMON_UNAVAILABLE;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * A local daemon that resolves paths for other editorconfig processes over a
+ * Unix domain socket, so that they share its warm caches, and the client
+ * side of it.
+ *
+ * Every message is a 32-bit little-endian length followed by that many
+ * bytes. A request is
+ *
+ *   u8 major, u8 minor, u8 patch   the version to act as, 0.0.0 for current
+ *   conf file name, NUL            empty for ".editorconfig"
+ *   full path                      up to the end of the message
+ *
+ * and the response is
+ *
+ *   i32 err_num                    what editorconfig_parse() returned
+ *   result                         editorconfig_result_serialize() output,
+ *                                  only if err_num is 0
+ *
+ * A connection can carry any number of requests, answered in order. The
+ * socket file is only accessible to the user running the daemon, and both
+ * sides hang up on a peer running as another user.
+ */
+
+#ifndef DAEMON_H__
+#define DAEMON_H__
+
+#include <stddef.h>
+#include <editorconfig/editorconfig.h>
+
+/* returned by daemon_client_parse() if the daemon could not be asked */
+#define DAEMON_UNAVAILABLE      (-100)
+
+/*
+ * Serves requests on socket_path until no client has been connected for
+ * idle_timeout seconds, or forever if idle_timeout is 0. Each client is
+ * served on its own thread. Returns the exit status of the process.
+ */
+int daemon_serve(const char* socket_path, int idle_timeout);
+
+typedef struct
+{
+    int             fd;
+    unsigned char*  buf;
+    size_t          size;
+} daemon_client;
+
+/*
+ * Connects to the daemon listening on socket_path. Returns 0 if successful,
+ * -1 if no daemon of this user is running there.
+ */
+int daemon_client_connect(daemon_client* client, const char* socket_path);
+
+void daemon_client_close(daemon_client* client);
+
+/*
+ * Resolves full_filename through the daemon, with the conf file name and
+ * version of eh, and stores the result in eh. Returns what
+ * editorconfig_parse() returned in the daemon, or DAEMON_UNAVAILABLE if the
+ * connection failed, in which case it is closed.
+ */
+int daemon_client_parse(daemon_client* client, const char* full_filename,
+        editorconfig_handle eh);
+
+#endif /* !DAEMON_H__ */
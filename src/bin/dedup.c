@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "dedup.h"
+
+/*
+ * See header file
+ */
+int dedup_init(dedup_table* table)
+{
+    table->capacity = 256;
+    table->count = 0;
+    table->entries = (dedup_entry*)calloc(table->capacity,
+            sizeof(dedup_entry));
+    table->data_size = 4096;
+    table->data_used = 0;
+    table->data = (unsigned char*)malloc(table->data_size);
+
+    return table->entries && table->data ? 0 : -1;
+}
+
+/*
+ * See header file
+ */
+void dedup_free(dedup_table* table)
+{
+    free(table->entries);
+    free(table->data);
+    table->entries = NULL;
+    table->data = NULL;
+}
+
+/*
+ * Doubles the capacity of the entries. Returns -1 if out of memory.
+ */
+static int dedup_grow(dedup_table* table)
+{
+    size_t          capacity = table->capacity * 2;
+    dedup_entry*    entries;
+    size_t          i;
+
+    entries = (dedup_entry*)calloc(capacity, sizeof(dedup_entry));
+    if (entries == NULL)
+        return -1;
+
+    for (i = 0; i < table->capacity; ++i) {
+        size_t      j;
+
+        if (table->entries[i].id == 0)
+            continue;
+        j = (size_t)table->entries[i].fingerprint & (capacity - 1);
+        while (entries[j].id != 0)
+            j = (j + 1) & (capacity - 1);
+        entries[j] = table->entries[i];
+    }
+
+    free(table->entries);
+    table->entries = entries;
+    table->capacity = capacity;
+
+    return 0;
+}
+
+/*
+ * See header file
+ */
+int dedup_lookup(dedup_table* table, editorconfig_handle eh, _Bool* is_new)
+{
+    unsigned long long  fingerprint = editorconfig_handle_get_fingerprint(eh);
+    size_t              length;
+    unsigned char*      serialized;
+    size_t              i;
+
+    /* serialize at the end of the data, where it stays if it is new */
+    length = editorconfig_result_serialize(eh, NULL, 0,
+            table->data + table->data_used,
+            table->data_size - table->data_used);
+    if (length > table->data_size - table->data_used) {
+        size_t          size = table->data_size * 2;
+        unsigned char*  data;
+
+        while (size - table->data_used < length)
+            size *= 2;
+        data = (unsigned char*)realloc(table->data, size);
+        if (data == NULL)
+            return -1;
+        table->data = data;
+        table->data_size = size;
+        editorconfig_result_serialize(eh, NULL, 0,
+                table->data + table->data_used, length);
+    }
+    serialized = table->data + table->data_used;
+
+    *is_new = 0;
+    i = (size_t)fingerprint & (table->capacity - 1);
+    while (table->entries[i].id != 0) {
+        dedup_entry*    entry = &table->entries[i];
+
+        if (entry->fingerprint == fingerprint && entry->length == length &&
+                !memcmp(table->data + entry->offset, serialized, length))
+            return entry->id;
+        i = (i + 1) & (table->capacity - 1);
+    }
+
+    /* a new result, keep it at most half full */
+    table->entries[i].fingerprint = fingerprint;
+    table->entries[i].id = ++ table->count;
+    table->entries[i].offset = table->data_used;
+    table->entries[i].length = length;
+    table->data_used += length;
+    *is_new = 1;
+
+    if ((size_t)table->count * 2 > table->capacity && dedup_grow(table))
+        return -1;
+
+    return table->count;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Gives every distinct parsing result an ID, for printing each result only
+ * once. Results are looked up by their fingerprint, and the serialized
+ * results are compared to tell apart different results that happen to have
+ * the same fingerprint.
+ */
+
+#ifndef DEDUP_H__
+#define DEDUP_H__
+
+#include <stddef.h>
+#include <editorconfig/editorconfig.h>
+
+typedef struct
+{
+    unsigned long long  fingerprint;
+    int                 id;
+    /* where the serialized result is in the data of the table */
+    size_t              offset;
+    size_t              length;
+} dedup_entry;
+
+typedef struct
+{
+    /* open addressing on the fingerprint, the capacity is a power of 2 */
+    dedup_entry*        entries;
+    size_t              capacity;
+    int                 count;
+    /* the serialized results, one after another */
+    unsigned char*      data;
+    size_t              data_size;
+    size_t              data_used;
+} dedup_table;
+
+/*
+ * Set up an empty table. Returns 0 if successful, -1 if out of memory.
+ */
+int dedup_init(dedup_table* table);
+
+void dedup_free(dedup_table* table);
+
+/*
+ * Returns the ID of the result held by eh, starting from 1, adding it to the
+ * table if it is not there yet, in which case is_new is set. Returns -1 if
+ * out of memory.
+ */
+int dedup_lookup(dedup_table* table, editorconfig_handle eh, _Bool* is_new);
+
+#endif /* !DEDUP_H__ */
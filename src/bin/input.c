@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "input.h"
+
+/*
+ * See header file
+ */
+int input_init(input_reader* in, int fd, char delimiter, size_t size)
+{
+    in->fd = fd;
+    in->delimiter = delimiter;
+    in->size = size;
+    in->start = in->end = 0;
+    in->eof = 0;
+    in->error = 0;
+    /* one more byte to terminate a last record that has no delimiter */
+    in->buf = (char*)malloc(size + 1);
+
+    return in->buf ? 0 : -1;
+}
+
+/*
+ * See header file
+ */
+void input_free(input_reader* in)
+{
+    free(in->buf);
+    in->buf = NULL;
+}
+
+/*
+ * See header file
+ */
+char* input_next(input_reader* in, size_t* len)
+{
+    for (;;) {
+        char*       record = in->buf + in->start;
+        char*       delimiter;
+        ssize_t     n;
+
+        delimiter = (char*)memchr(record, in->delimiter, in->end - in->start);
+        if (delimiter) {
+            *delimiter = '\0';
+            *len = delimiter - record;
+            in->start = delimiter + 1 - in->buf;
+            return record;
+        }
+
+        if (in->eof) {
+            if (in->start == in->end)
+                return NULL;
+
+            in->buf[in->end] = '\0';
+            *len = in->end - in->start;
+            in->start = in->end;
+            return record;
+        }
+
+        /* keep the start of the record and read the rest after it */
+        if (in->start > 0) {
+            memmove(in->buf, record, in->end - in->start);
+            in->end -= in->start;
+            in->start = 0;
+        }
+
+        if (in->end == in->size) {
+            char*   buf = (char*)realloc(in->buf, in->size * 2 + 1);
+
+            if (buf == NULL) {
+                in->error = ENOMEM;
+                in->eof = 1;
+                return NULL;
+            }
+            in->buf = buf;
+            in->size *= 2;
+        }
+
+        n = read(in->fd, in->buf + in->end, in->size - in->end);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            in->error = errno;
+            in->eof = 1;
+            return NULL;
+        }
+
+        if (n == 0)
+            in->eof = 1;
+        else
+            in->end += n;
+    }
+}
+
+/*
+ * See header file
+ */
+_Bool input_ready(const input_reader* in)
+{
+    struct pollfd   pfd;
+
+    if (in->eof || memchr(in->buf + in->start, in->delimiter,
+                in->end - in->start))
+        return 1;
+
+    pfd.fd = in->fd;
+    pfd.events = POLLIN;
+    return poll(&pfd, 1, 0) != 0;
+}
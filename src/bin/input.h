@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Reads delimited records, such as the lines or the NUL-separated paths
+ * given on stdin, in large blocks. Records are split in place in the buffer,
+ * so they are not copied.
+ */
+
+#ifndef INPUT_H__
+#define INPUT_H__
+
+#include <stddef.h>
+
+/* the default size of the buffer, it grows if a record does not fit */
+#define INPUT_BUFFER_SIZE       (1024 * 1024)
+
+typedef struct
+{
+    int         fd;
+    char        delimiter;
+    char*       buf;
+    size_t      size;
+    /* where the next record starts */
+    size_t      start;
+    /* the end of the data read so far */
+    size_t      end;
+    _Bool       eof;
+    /* the errno of a failed read, or 0 */
+    int         error;
+} input_reader;
+
+/*
+ * Set up in to read records ending with delimiter from fd, through a buffer
+ * of size bytes. Returns 0 if successful, -1 if out of memory.
+ */
+int input_init(input_reader* in, int fd, char delimiter, size_t size);
+
+/*
+ * Free the buffer of in. fd is not closed.
+ */
+void input_free(input_reader* in);
+
+/*
+ * Return the next record, null-terminated in place of its delimiter, and set
+ * len to its length. The last record may have no delimiter. The record stays
+ * valid until the next call. Returns NULL at the end of the input, or if
+ * reading fails, in which case error is set.
+ */
+char* input_next(input_reader* in, size_t* len);
+
+/*
+ * Return whether input_next() can return without waiting for more input.
+ */
+_Bool input_ready(const input_reader* in);
+
+#endif /* !INPUT_H__ */
@@ -26,13 +26,49 @@
 
 #include "config.h"
 #include <ctype.h>
+#include <limits.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dispatch/dispatch.h>
 #include <editorconfig/editorconfig.h>
 
 #include "util.h"
+#include "bench.h"
+#include "json.h"
+#include "daemon.h"
+#include "dedup.h"
+#include "input.h"
+#include "output.h"
+#include "trace.h"
+#include "walk.h"
+
+/* Everything printed to stdout goes through this buffer */
+static output_buffer    out;
+/* Set if stdout is a terminal: the buffer is flushed after each path, so
+ * that paths typed one at a time get their answer right away */
+static _Bool            interactive;
+
+/* Set with --dedup: each distinct result is printed only once */
+static _Bool            dedup_mode;
+static dedup_table      results;
+
+/* Set with --stats: what each lookup did is printed to stderr */
+static _Bool            stats_mode;
+/* Set with --dump-cache: the caches are printed to stderr at the end */
+static _Bool            dump_cache_mode;
+/* Set with --profile-config: the cost of each section is printed to stderr
+ * at the end */
+static _Bool            profile_mode;
+/* Set with --trace: the spans of work of the lookups are written there */
+static const char*      trace_path;
+
+/* Set with --socket: paths are resolved by the daemon listening there, if
+ * any. Only used when resolving one path at a time. */
+static daemon_client    client = { -1, NULL, 0 };
 
 
 static void version(FILE* stream)
@@ -51,37 +87,718 @@ static void usage(FILE* stream, const char* command)
 {
     fprintf(stream, "Usage: %s [OPTIONS] FILEPATH1 [FILEPATH2 FILEPATH3 ...]\n", command);
     fprintf(stream, "FILEPATH can be a hyphen (-) if you want to path(s) to be read from stdin.\n");
+    fprintf(stream, "       %s [OPTIONS] --files-from FILE\n", command);
+    fprintf(stream, "       %s [OPTIONS] -r DIR\n", command);
 
     fprintf(stream, "\n");
     fprintf(stream, "-f                 Specify conf filename other than \".editorconfig\".\n");
     fprintf(stream, "-b                 Specify version (used by devs to test compatibility).\n");
+    fprintf(stream, "-j N               Resolve N paths at a time. The output stays in input order.\n");
+    fprintf(stream, "-0                 Paths read from stdin or FILE are separated by NUL, not newlines.\n");
+    fprintf(stream, "--files-from FILE  Read the paths from FILE, or from stdin if FILE is -.\n");
+    fprintf(stream, "-r DIR             Resolve every regular file under DIR.\n");
+    fprintf(stream, "--include GLOB     With -r, only resolve files matching GLOB. May be repeated.\n");
+    fprintf(stream, "--exclude GLOB     With -r, skip files and directories matching GLOB. May be repeated.\n");
+    fprintf(stream, "                   A GLOB with a slash is matched against the path relative to DIR.\n");
+    fprintf(stream, "--max-depth N      With -r, go at most N levels of directories down.\n");
+    fprintf(stream, "--follow-symlinks  With -r, follow symbolic links instead of skipping them.\n");
+    fprintf(stream, "--dedup            Print each distinct result once as [@ID], then PATH<TAB>ID per path.\n");
+    fprintf(stream, "--stats            Print to stderr what resolving each path took: configs read\n");
+    fprintf(stream, "                   from disk and cache, globs compiled and matched, time per phase.\n");
+    fprintf(stream, "--dump-cache       Print the cached glob patterns and .editorconfig files to stderr\n");
+    fprintf(stream, "                   as JSON lines once all paths are resolved.\n");
+    fprintf(stream, "--profile-config   Print to stderr the time spent matching against each section of\n");
+    fprintf(stream, "                   each .editorconfig file once all paths are resolved, costliest first.\n");
+    fprintf(stream, "--trace FILE       Write the spans of work of the lookups to FILE as Chrome trace events.\n");
+    fprintf(stream, "--socket PATH      Resolve through the daemon listening on PATH, if it is running.\n");
+    fprintf(stream, "--daemon           With --socket, serve other editorconfig processes on PATH.\n");
+    fprintf(stream, "--idle-timeout N   Make the daemon exit after N seconds without clients (default 600).\n");
+    fprintf(stream, "--batch-server     Answer requests read from stdin until it is closed. A request is\n");
+    fprintf(stream, "                   a line PATH[<TAB>CONF_FILENAME[<TAB>VERSION]], the response is\n");
+    fprintf(stream, "                   \"ok N\" and N name=value lines, or \"error CODE MESSAGE\".\n");
+    fprintf(stream, "--bench            Time the resolution of the paths with cold and warm caches, and\n");
+    fprintf(stream, "                   print throughput, latencies and cache hit rates as JSON.\n");
+    fprintf(stream, "--bench-threads L  With --bench, run on each of the comma-separated thread counts in L\n");
+    fprintf(stream, "                   (default: the -j value).\n");
     fprintf(stream, "-h OR --help       Print this help message.\n");
     fprintf(stream, "-v OR --version    Display version information.\n");
 }
 
 /*
- * Returns strdup(s) and exits if it fails.
+ * Converts a version number such as "0.9.1" into its parts. Parts that are
+ * not given are left as they are. Returns -1 if there are more than three,
+ * or if one is not a number.
+ */
+static int parse_version(const char* str, int* major, int* minor, int* patch)
+{
+    int*        parts[3];
+    int         part_count = 0;
+
+    parts[0] = major;
+    parts[1] = minor;
+    parts[2] = patch;
+
+    while (*str) {
+        if (*str == '.') {
+            ++ str;
+            continue;
+        }
+
+        if (part_count == 3 || strspn(str, "0123456789") != strcspn(str, "."))
+            return -1;
+        *parts[part_count++] = ec_atoi(str);
+        str += strcspn(str, ".");
+    }
+
+    return 0;
+}
+
+/*
+ * Converts a comma-separated list of thread counts for --bench-threads into
+ * counts, which must have room for strlen(str) / 2 + 1 of them. Returns the
+ * number of counts, or -1 if one is not a positive number.
+ */
+static int parse_thread_counts(const char* str, int* counts)
+{
+    int         n = 0;
+
+    do {
+        char*       end;
+        long        count = strtol(str, &end, 10);
+
+        if (end == str || count < 1 || count > 4096 ||
+                (*end != ',' && *end != '\0'))
+            return -1;
+        counts[n++] = (int)count;
+        str = *end ? end + 1 : end;
+    } while (*str);
+
+    return n;
+}
+
+/*
+ * Converts str into a number that is not negative. Returns -1 if it is not
+ * one.
+ */
+static int parse_non_negative(const char* str, int* value)
+{
+    char*       end;
+    long        n = strtol(str, &end, 10);
+
+    if (end == str || *end != '\0' || n < 0 || n > INT_MAX)
+        return -1;
+    *value = (int)n;
+
+    return 0;
+}
+
+/*
+ * Exits if writing to stdout failed.
+ */
+static void check_output(int failed)
+{
+    if (failed)
+    {
+        perror("Failed to write output");
+        exit(1);
+    }
+}
+
+/*
+ * Prints "[path]" to o.
+ */
+static void print_path(output_buffer* o, const char* path)
+{
+    size_t      len = strlen(path);
+    char*       p = output_reserve(o, len + 3);
+
+    check_output(p == NULL);
+    *p++ = '[';
+    memcpy(p, path, len);
+    p += len;
+    *p++ = ']';
+    *p = '\n';
+}
+
+/*
+ * Prints the "name=value" lines of the parsing result in eh to o.
+ */
+static void print_result(output_buffer* o, editorconfig_handle eh)
+{
+    int         name_value_count;
+    int         j;
+
+    name_value_count = editorconfig_handle_get_name_value_count(eh);
+    for (j = 0; j < name_value_count; ++j) {
+        const char*         name;
+        const char*         value;
+        size_t              name_len;
+        size_t              value_len;
+        char*               p;
+
+        editorconfig_handle_get_name_value(eh, j, &name, &value);
+        name_len = strlen(name);
+        value_len = strlen(value);
+
+        p = output_reserve(o, name_len + value_len + 2);
+        check_output(p == NULL);
+        memcpy(p, name, name_len);
+        p += name_len;
+        *p++ = '=';
+        memcpy(p, value, value_len);
+        p += value_len;
+        *p = '\n';
+    }
+}
+
+/*
+ * Prints "path<TAB>id" for the result in eh, preceded by "[@id]" and the
+ * result itself if no path had this result before.
+ */
+static void print_dedup(output_buffer* o, editorconfig_handle eh,
+        const char* path)
+{
+    _Bool       is_new;
+    int         id = dedup_lookup(&results, eh, &is_new);
+    char        id_str[16];
+    int         id_len;
+    size_t      len = strlen(path);
+    char*       p;
+
+    if (id < 0)
+    {
+        perror("Unable to allocate memory");
+        exit(2);
+    }
+    id_len = sprintf(id_str, "%d", id);
+
+    if (is_new) {
+        p = output_reserve(o, id_len + 4);
+        check_output(p == NULL);
+        memcpy(p, "[@", 2);
+        memcpy(p + 2, id_str, id_len);
+        memcpy(p + 2 + id_len, "]\n", 2);
+        print_result(o, eh);
+    }
+
+    p = output_reserve(o, len + id_len + 2);
+    check_output(p == NULL);
+    memcpy(p, path, len);
+    p += len;
+    *p++ = '\t';
+    memcpy(p, id_str, id_len);
+    p[id_len] = '\n';
+}
+
+/*
+ * Prints the statistics of the last lookup with eh to stderr, for --stats.
+ */
+static void print_stats(editorconfig_handle eh, const char* full_filename)
+{
+    editorconfig_query_stats    s;
+
+    if (editorconfig_handle_get_stats(eh, &s) != 0)
+        return;
+
+    fprintf(stderr, "%s: ancestors=%llu configs_from_disk=%llu "
+            "configs_from_cache=%llu bytes_parsed=%llu sections=%llu "
+            "glob_compiles=%llu glob_cache_hits=%llu glob_cache_misses=%llu "
+            "glob_matches=%llu discover_ns=%llu load_ns=%llu parse_ns=%llu "
+            "glob_compile_ns=%llu glob_match_ns=%llu merge_ns=%llu "
+            "total_ns=%llu\n", full_filename, s.ancestors,
+            s.configs_from_disk, s.configs_from_cache, s.bytes_parsed,
+            s.sections, s.glob_compiles, s.glob_cache_hits,
+            s.glob_cache_misses, s.glob_matches, s.discover_ns, s.load_ns,
+            s.parse_ns, s.glob_compile_ns, s.glob_match_ns, s.merge_ns,
+            s.total_ns);
+}
+
+/*
+ * Prints an entry of the glob pattern cache as a line of JSON, for
+ * --dump-cache.
+ */
+static void print_glob_cache_entry(const editorconfig_glob_cache_entry* entry,
+        void* user)
+{
+    FILE*   stream = (FILE*)user;
+
+    fputs("{\"cache\": \"glob\", \"pattern\": ", stream);
+    json_print_string(stream, entry->pattern);
+    fprintf(stream, ", \"compiled_size\": %llu, \"hits\": %llu, "
+            "\"idle_ns\": %llu}\n", entry->compiled_size, entry->hits,
+            entry->idle_ns);
+}
+
+/*
+ * Prints an entry of the .editorconfig file cache as a line of JSON, for
+ * --dump-cache.
+ */
+static void print_file_cache_entry(const editorconfig_file_cache_entry* entry,
+        void* user)
+{
+    static const char*  watches[] = { "none", "file", "directory" };
+    FILE*               stream = (FILE*)user;
+
+    fputs("{\"cache\": \"file\", \"path\": ", stream);
+    json_print_string(stream, entry->path);
+    fprintf(stream, ", \"exists\": %s, \"watch\": \"%s\", "
+            "\"bytes\": %llu, \"sections\": %llu, \"properties\": %llu, "
+            "\"hits\": %llu, \"age_ns\": %llu, \"idle_ns\": %llu}\n",
+            entry->exists ? "true" : "false", watches[entry->watch],
+            entry->bytes, entry->sections, entry->properties, entry->hits,
+            entry->age_ns, entry->idle_ns);
+}
+
+/*
+ * Prints a line of the --profile-config report.
  */
-static char* xstrdup(const char* s)
+static void print_profile_entry(const editorconfig_profile_entry* entry,
+        void* user)
 {
-    char* new_s = strdup(s);
-    if (new_s == NULL)
+    FILE*   stream = (FILE*)user;
+
+    fprintf(stream, "%12.1f %10llu %10llu %10.1f  %s [%s]\n",
+            entry->match_ns / 1e3, entry->attempts, entry->matches,
+            entry->max_match_ns / 1e3, entry->config_file, entry->section);
+}
+
+/*
+ * Prints the error that editorconfig_parse() returned for eh, after what was
+ * printed so far, and exits.
+ */
+static void report_error(int err_num, editorconfig_handle eh)
+{
+    check_output(output_flush(&out));
+    fputs(editorconfig_get_error_msg(err_num), stderr);
+    if (err_num > 0)
+        fprintf(stderr, ":%d \"%s\"", err_num,
+                editorconfig_handle_get_err_file(eh));
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+/*
+ * Creates a handle with the options given on the command line.
+ */
+static editorconfig_handle create_handle(const char* conf_filename,
+        int version_major, int version_minor, int version_patch)
+{
+    editorconfig_handle     eh = editorconfig_handle_init();
+
+    if (eh == NULL)
     {
-        fprintf(stderr, "Unable to allocate memory.\n");
+        perror("Unable to create EditorConfig handle");
+        exit(3);
+    }
+
+    /* Set conf file name */
+    if (conf_filename)
+        editorconfig_handle_set_conf_file_name(eh, conf_filename);
+
+    /* Set the version to be compatible with */
+    editorconfig_handle_set_version(eh,
+            version_major, version_minor, version_patch);
+
+    if (stats_mode)
+        editorconfig_handle_set_stats_enabled(eh, 1);
+
+    return eh;
+}
+
+/*
+ * Where the paths to resolve come from: the command line, where "-" stands
+ * for the paths read from input, which is stdin or the --files-from file, or
+ * the directory walked with -r.
+ */
+typedef struct
+{
+    const char**    file_paths;
+    int             path_count;
+    int             index;
+    input_reader    input;
+    /* the name of the input for error messages */
+    const char*     input_name;
+    /* set with -r */
+    walk_state*     walk;
+} path_source;
+
+/*
+ * Reports a file or directory that -r could not read, and goes on.
+ */
+static void warn_walk(const char* path, int err)
+{
+    check_output(output_flush(&out));
+    fprintf(stderr, "%s: %s\n", path, strerror(err));
+}
+
+/*
+ * Returns the next path to resolve and sets len to its length, or returns
+ * NULL if there are no more. The path is valid until the next call.
+ * show_header is set if its result should be preceded by "[path]".
+ */
+static const char* next_path(path_source* src, size_t* len,
+        _Bool* show_header)
+{
+    if (src->walk) {
+        *show_header = 1;
+        return walk_next(src->walk, len);
+    }
+
+    while (src->index < src->path_count) {
+        const char*     full_filename = src->file_paths[src->index];
+        char*           record;
+
+        if (strcmp(full_filename, "-")) {
+            ++ src->index;
+            *len = strlen(full_filename);
+            *show_header = src->path_count > 1;
+            return full_filename;
+        }
+
+        /* Read a path from input. If EOF encountered, continue */
+        record = input_next(&src->input, len);
+        if (record == NULL) {
+            if (src->input.error) {
+                check_output(output_flush(&out));
+                fprintf(stderr, "Failed to read %s: %s\n",
+                        src->input_name, strerror(src->input.error));
+                src->input.error = 0;
+            }
+
+            ++ src->index;
+            continue;
+        }
+
+        /* Newline separated paths are trimmed of space characters, NUL
+         * separated ones are taken as they are */
+        if (src->input.delimiter == '\n') {
+            while (*len > 0 && isspace(record[*len - 1]))
+                -- *len;
+            record[*len] = '\0';
+            while (isspace(*record)) {
+                ++ record;
+                -- *len;
+            }
+        }
+        if (*len == 0) /* we meet a blank line */
+            continue;
+
+        *show_header = 1;
+        return record;
+    }
+
+    return NULL;
+}
+
+/*
+ * Runs editorconfig_parse() for full_filename, or lets the daemon do it if
+ * there is one.
+ */
+static int parse_path(const char* full_filename, editorconfig_handle eh)
+{
+    /* the daemon does not send statistics back, and fills its own caches,
+     * profile and trace */
+    if (client.fd >= 0 && !stats_mode && !dump_cache_mode && !profile_mode &&
+            !trace_path &&
+            daemon_client_parse(&client, full_filename, eh) == 0)
+        return 0;
+
+    /* Without a daemon, and on errors so that they are reported with the
+     * file that caused them */
+    return editorconfig_parse(full_filename, eh);
+}
+
+/*
+ * Prints the header if asked to and the result for full_filename to o.
+ * Returns the value of editorconfig_parse(). In dedup mode nothing is
+ * printed, print_dedup() is called in input order instead.
+ */
+static int resolve_path(editorconfig_handle eh, const char* full_filename,
+        _Bool show_header, output_buffer* o)
+{
+    int         err_num;
+
+    if (show_header && !dedup_mode)
+        print_path(o, full_filename);
+
+    /* parsing the editorconfig files */
+    err_num = parse_path(full_filename, eh);
+
+    if (err_num == 0 && !dedup_mode)
+        print_result(o, eh);
+
+    return err_num;
+}
+
+/*
+ * Answers requests read from input until it ends, for --batch-server. Each
+ * request is a line "PATH[<TAB>CONF_FILE_NAME[<TAB>VERSION]]", empty fields
+ * meaning the defaults given on the command line. The response is "ok N"
+ * followed by the N name=value lines of the result, or a single line
+ * "error CODE MESSAGE". Every response is flushed right away, so the caller
+ * can wait for it before sending the next request.
+ */
+static void serve_batch(input_reader* input, const char* conf_filename,
+        int version_major, int version_minor, int version_patch)
+{
+    editorconfig_handle     eh = create_handle(NULL, -1, -1, -1);
+    char*                   request;
+    size_t                  len;
+
+    while ((request = input_next(input, &len)) != NULL) {
+        const char*     full_filename = request;
+        const char*     conf = NULL;
+        const char*     ver = NULL;
+        char*           tab;
+        int             major = version_major;
+        int             minor = version_minor;
+        int             patch = version_patch;
+        int             err_num;
+        char            line[64];
+
+        /* tolerate CRLF line endings */
+        if (len > 0 && request[len - 1] == '\r')
+            request[len - 1] = '\0';
+
+        if ((tab = strchr(request, '\t')) != NULL) {
+            *tab = '\0';
+            conf = tab + 1;
+            if ((tab = strchr(tab + 1, '\t')) != NULL) {
+                *tab = '\0';
+                ver = tab + 1;
+            }
+        }
+
+        editorconfig_handle_set_conf_file_name(eh,
+                conf && *conf ? conf : conf_filename);
+
+        if (ver && *ver && parse_version(ver, &major, &minor, &patch)) {
+            /* an error of the library, as for all other errors */
+            check_output(output_write(&out, line,
+                        sprintf(line, "error %d %s\n",
+                            EDITORCONFIG_PARSE_INVALID_ARGUMENT,
+                            editorconfig_get_error_msg(
+                                EDITORCONFIG_PARSE_INVALID_ARGUMENT))));
+            check_output(output_flush(&out));
+            continue;
+        }
+        /* the version of the previous request must not stick */
+        editorconfig_handle_set_version(eh, major < 0 ? 0 : major,
+                minor < 0 ? 0 : minor, patch < 0 ? 0 : patch);
+
+        err_num = editorconfig_parse(full_filename, eh);
+        if (err_num == 0) {
+            check_output(output_write(&out, line, sprintf(line, "ok %d\n",
+                            editorconfig_handle_get_name_value_count(eh))));
+            print_result(&out, eh);
+        } else {
+            const char*     msg = editorconfig_get_error_msg(err_num);
+
+            check_output(output_write(&out, line,
+                        sprintf(line, "error %d ", err_num)));
+            check_output(output_write(&out, msg, strlen(msg)));
+            if (err_num > 0) {
+                const char* err_file = editorconfig_handle_get_err_file(eh);
+
+                check_output(output_write(&out, line,
+                            sprintf(line, ":%d \"", err_num)));
+                check_output(output_write(&out, err_file, strlen(err_file)));
+                check_output(output_write(&out, "\"", 1));
+            }
+            check_output(output_write(&out, "\n", 1));
+        }
+
+        check_output(output_flush(&out));
+    }
+
+    if (input->error) {
+        fprintf(stderr, "Failed to read stdin: %s\n", strerror(input->error));
         exit(1);
     }
-    return new_s;
+
+    editorconfig_handle_destroy(eh);
+}
+
+/*
+ * Returns whether next_path() may have to wait for more input.
+ */
+static _Bool next_path_would_wait(const path_source* src)
+{
+    if (src->walk || src->index >= src->path_count ||
+            strcmp(src->file_paths[src->index], "-"))
+        return 0;
+
+    return !input_ready(&src->input);
+}
+
+/*
+ * A path being resolved in parallel mode. The slots form a ring that is
+ * filled in input order and printed in the same order once each is done, so
+ * at most that many paths are held in memory however many are read.
+ */
+typedef struct
+{
+    editorconfig_handle     eh;
+    /* a copy of the path, the buffer is reused for the next paths */
+    char*                   full_filename;
+    size_t                  full_filename_size;
+    _Bool                   show_header;
+    int                     err_num;
+    /* the output of this path, kept until it is its turn to be printed */
+    output_buffer           out;
+    /* signaled when the result is ready */
+    dispatch_semaphore_t    done;
+} job_slot;
+
+/* limits the count of paths being resolved at the same time to -j */
+static dispatch_semaphore_t     job_limit;
+
+static void resolve_slot(void* context)
+{
+    job_slot*   slot = (job_slot*)context;
+
+    slot->out.used = 0;
+    slot->err_num = resolve_path(slot->eh, slot->full_filename,
+            slot->show_header, &slot->out);
+
+    dispatch_semaphore_signal(slot->done);
+    dispatch_semaphore_signal(job_limit);
+}
+
+/*
+ * Waits up to timeout for the result in slot and prints it. Returns 0 if it
+ * was not ready in time.
+ */
+static _Bool print_slot(job_slot* slot, dispatch_time_t timeout)
+{
+    if (dispatch_semaphore_wait(slot->done, timeout) != 0)
+        return 0;
+
+    check_output(output_write(&out, slot->out.buf, slot->out.used));
+    if (slot->err_num != 0)
+        report_error(slot->err_num, slot->eh);
+    if (stats_mode)
+        print_stats(slot->eh, slot->full_filename);
+    if (dedup_mode)
+        print_dedup(&out, slot->eh, slot->full_filename);
+    if (interactive)
+        check_output(output_flush(&out));
+
+    return 1;
+}
+
+/*
+ * Resolves the paths of src on job_count threads. The library caches are
+ * shared by all of them.
+ */
+static void resolve_parallel(path_source* src, int job_count,
+        const char* conf_filename,
+        int version_major, int version_minor, int version_patch)
+{
+    /* enough slots to keep every thread busy while waiting for a slow path
+     * at the head of the ring */
+    size_t          slot_count = (size_t)job_count * 16;
+    job_slot*       slots;
+    size_t          submitted = 0;
+    size_t          printed = 0;
+    size_t          i;
+    const char*     full_filename;
+    size_t          len;
+    _Bool           show_header;
+
+    slots = (job_slot*)calloc(slot_count, sizeof(job_slot));
+    if (slots == NULL)
+    {
+        perror("Unable to allocate memory");
+        exit(2);
+    }
+
+    for (i = 0; i < slot_count; ++i) {
+        slots[i].eh = create_handle(conf_filename,
+                version_major, version_minor, version_patch);
+        slots[i].done = dispatch_semaphore_create(0);
+        /* the output of a single path is small, and grows if it is not */
+        if (output_init(&slots[i].out, -1, 4096))
+        {
+            perror("Unable to allocate memory");
+            exit(2);
+        }
+    }
+
+    job_limit = dispatch_semaphore_create(job_count);
+
+    for (;;) {
+        job_slot*   slot;
+
+        /* on a terminal, show what is done, and all of it before waiting
+         * for the next path to be typed */
+        if (interactive) {
+            dispatch_time_t     timeout = next_path_would_wait(src) ?
+                DISPATCH_TIME_FOREVER : DISPATCH_TIME_NOW;
+
+            while (printed < submitted &&
+                    print_slot(&slots[printed % slot_count], timeout))
+                ++ printed;
+        }
+
+        if ((full_filename = next_path(src, &len, &show_header)) == NULL)
+            break;
+
+        /* print the oldest result first if the ring is full */
+        if (submitted - printed == slot_count)
+            print_slot(&slots[printed++ % slot_count], DISPATCH_TIME_FOREVER);
+
+        slot = &slots[submitted++ % slot_count];
+        if (slot->full_filename_size < len + 1) {
+            free(slot->full_filename);
+            slot->full_filename_size = len + 1 > FILENAME_MAX ?
+                len + 1 : FILENAME_MAX;
+            slot->full_filename = (char*)malloc(slot->full_filename_size);
+            if (slot->full_filename == NULL)
+            {
+                perror("Unable to allocate memory");
+                exit(2);
+            }
+        }
+        memcpy(slot->full_filename, full_filename, len + 1);
+        slot->show_header = show_header;
+
+        dispatch_semaphore_wait(job_limit, DISPATCH_TIME_FOREVER);
+        dispatch_async_f(dispatch_get_global_queue(
+                    DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+                slot, resolve_slot);
+    }
+
+    while (printed < submitted)
+        print_slot(&slots[printed++ % slot_count], DISPATCH_TIME_FOREVER);
+
+    for (i = 0; i < slot_count; ++i) {
+        editorconfig_handle_destroy(slots[i].eh);
+        free(slots[i].full_filename);
+        dispatch_release(slots[i].done);
+        output_free(&slots[i].out);
+    }
+    dispatch_release(job_limit);
+    free(slots);
 }
 
 int main(int argc, const char* argv[])
 {
-    char*                               full_filename = NULL;
     int                                 err_num;
     int                                 i;
-    int                                 name_value_count;
     editorconfig_handle                 eh;
-    char**                              file_paths = NULL;
+    const char*                         full_filename;
+    size_t                              len;
+    _Bool                               show_header;
+    path_source                         src;
+    const char**                        file_paths = NULL;
     int                                 path_count; /* the count of path input*/
+    /* the file given with --files-from */
+    const char*                         files_from = NULL;
+    const char*                         stdin_path = "-";
+    int                                 input_fd = 0;
+    /* the separator of the paths read from input, NUL with -0 */
+    char                                delimiter = '\n';
     /* Will be a EditorConfig file name if -f is specified on command line */
     const char*                         conf_filename = NULL;
 
@@ -89,11 +806,36 @@ int main(int argc, const char* argv[])
     int                                 version_minor = -1;
     int                                 version_patch = -1;
 
-    /* File names read from stdin are put in this buffer temporarily */
-    char                                file_line_buffer[FILENAME_MAX + 1];
+    /* the count of paths resolved at the same time, set with -j */
+    int                                 job_count = 1;
 
     _Bool                               f_flag = 0;
     _Bool                               b_flag = 0;
+    _Bool                               j_flag = 0;
+    _Bool                               files_from_flag = 0;
+    _Bool                               batch_server = 0;
+    _Bool                               socket_flag = 0;
+    _Bool                               idle_timeout_flag = 0;
+    _Bool                               trace_flag = 0;
+    _Bool                               daemon_mode = 0;
+    /* set with --socket */
+    const char*                         socket_path = NULL;
+    /* seconds without clients after which the daemon exits */
+    int                                 idle_timeout = 600;
+    /* set with -r and the options that go with it */
+    const char*                         walk_dir = NULL;
+    char*                               walk_root = NULL;
+    walk_state                          walk;
+    _Bool                               r_flag = 0;
+    _Bool                               include_flag = 0;
+    _Bool                               exclude_flag = 0;
+    _Bool                               max_depth_flag = 0;
+    _Bool                               follow_symlinks = 0;
+    /* set with --bench and --bench-threads */
+    _Bool                               bench_mode = 0;
+    _Bool                               bench_threads_flag = 0;
+    int*                                thread_counts = NULL;
+    int                                 run_count = 0;
 
     if (argc <= 1) {
         version(stderr);
@@ -101,47 +843,84 @@ int main(int argc, const char* argv[])
         exit(1);
     }
 
+    memset(&walk, 0, sizeof(walk));
+    walk.max_depth = -1;
+    walk.warn = warn_walk;
+    /* room for as many patterns as there are arguments */
+    walk.includes = (const char**)malloc(argc * sizeof(const char*));
+    walk.excludes = (const char**)malloc(argc * sizeof(const char*));
+    if (walk.includes == NULL || walk.excludes == NULL)
+    {
+        perror("Unable to allocate memory");
+        exit(2);
+    }
+
     for (i = 1; i < argc; ++i) {
 
         if (b_flag) {
-            char*             pos;
-            int               ver;
-            int               ver_pos = 0;
-            char*             argvi;
-
-            argvi = xstrdup(argv[i]);
-
             b_flag = 0;
 
             /* convert the argument -b into a version number */
-            pos = strtok(argvi, ".");
-
-            while (pos != NULL) {
-                ver = ec_atoi(pos);
-
-                switch(ver_pos) {
-                case 0:
-                    version_major = ver;
-                    break;
-                case 1:
-                    version_minor = ver;
-                    break;
-                case 2:
-                    version_patch = ver;
-                    break;
-                default:
-                    fprintf(stderr, "Invalid version number: %s\n", argv[i]);
-                    exit(1);
-                }
-                ++ ver_pos;
-
-                pos = strtok(NULL, ".");
+            if (parse_version(argv[i],
+                        &version_major, &version_minor, &version_patch)) {
+                fprintf(stderr, "Invalid version number: %s\n", argv[i]);
+                exit(1);
             }
-
-            free(argvi);
         } else if (f_flag) {
             f_flag = 0;
             conf_filename = argv[i];
+        } else if (j_flag) {
+            j_flag = 0;
+            job_count = ec_atoi(argv[i]);
+            if (job_count < 1) {
+                fprintf(stderr, "Invalid number of jobs: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (files_from_flag) {
+            files_from_flag = 0;
+            files_from = argv[i];
+        } else if (socket_flag) {
+            socket_flag = 0;
+            socket_path = argv[i];
+        } else if (idle_timeout_flag) {
+            idle_timeout_flag = 0;
+            if (parse_non_negative(argv[i], &idle_timeout)) {
+                fprintf(stderr, "Invalid idle timeout: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (trace_flag) {
+            trace_flag = 0;
+            trace_path = argv[i];
+        } else if (r_flag) {
+            r_flag = 0;
+            walk_dir = argv[i];
+        } else if (include_flag) {
+            include_flag = 0;
+            walk.includes[walk.include_count++] = argv[i];
+        } else if (exclude_flag) {
+            exclude_flag = 0;
+            walk.excludes[walk.exclude_count++] = argv[i];
+        } else if (max_depth_flag) {
+            max_depth_flag = 0;
+            if (parse_non_negative(argv[i], &walk.max_depth)) {
+                fprintf(stderr, "Invalid maximum depth: %s\n", argv[i]);
+                exit(1);
+            }
+        } else if (bench_threads_flag) {
+            bench_threads_flag = 0;
+            free(thread_counts);
+            thread_counts = (int*)malloc(
+                    (strlen(argv[i]) / 2 + 1) * sizeof(int));
+            if (thread_counts == NULL)
+            {
+                perror("Unable to allocate memory");
+                exit(2);
+            }
+            run_count = parse_thread_counts(argv[i], thread_counts);
+            if (run_count < 0) {
+                fprintf(stderr, "Invalid thread counts: %s\n", argv[i]);
+                exit(1);
+            }
         } else if (strcmp(argv[i], "--version") == 0 ||
                 strcmp(argv[i], "-v") == 0) {
             version(stdout);
@@ -155,123 +934,262 @@ int main(int argc, const char* argv[])
             b_flag = 1;
         else if (strcmp(argv[i], "-f") == 0)
             f_flag = 1;
+        else if (strcmp(argv[i], "-j") == 0)
+            j_flag = 1;
+        else if (strcmp(argv[i], "-0") == 0)
+            delimiter = '\0';
+        else if (strcmp(argv[i], "--files-from") == 0)
+            files_from_flag = 1;
+        else if (strcmp(argv[i], "--dedup") == 0)
+            dedup_mode = 1;
+        else if (strcmp(argv[i], "--stats") == 0)
+            stats_mode = 1;
+        else if (strcmp(argv[i], "--dump-cache") == 0)
+            dump_cache_mode = 1;
+        else if (strcmp(argv[i], "--profile-config") == 0)
+            profile_mode = 1;
+        else if (strcmp(argv[i], "--trace") == 0)
+            trace_flag = 1;
+        else if (strcmp(argv[i], "--batch-server") == 0)
+            batch_server = 1;
+        else if (strcmp(argv[i], "--socket") == 0)
+            socket_flag = 1;
+        else if (strcmp(argv[i], "--idle-timeout") == 0)
+            idle_timeout_flag = 1;
+        else if (strcmp(argv[i], "--daemon") == 0)
+            daemon_mode = 1;
+        else if (strcmp(argv[i], "-r") == 0)
+            r_flag = 1;
+        else if (strcmp(argv[i], "--include") == 0)
+            include_flag = 1;
+        else if (strcmp(argv[i], "--exclude") == 0)
+            exclude_flag = 1;
+        else if (strcmp(argv[i], "--max-depth") == 0)
+            max_depth_flag = 1;
+        else if (strcmp(argv[i], "--follow-symlinks") == 0)
+            follow_symlinks = 1;
+        else if (strcmp(argv[i], "--bench") == 0)
+            bench_mode = 1;
+        else if (strcmp(argv[i], "--bench-threads") == 0)
+            bench_threads_flag = 1;
         else if (i < argc) {
             /* If there are other args left, regard them as file names */
 
             path_count = argc - i;
-            file_paths = (char**) malloc(path_count * sizeof(char*));
-
-            if (file_paths == NULL)
-            {
-                perror("Unable to allocate memory");
-                exit(2);
-            }
-
-            for (; i < argc; ++i)
-                file_paths[path_count + i - argc] = xstrdup(argv[i]);
+            file_paths = argv + i;
+            break;
         } else {
             usage(stderr, argv[0]);
             exit(1);
         }
     }
 
-    if (!file_paths) { /* No filename is set */ 
-        usage(stderr, argv[0]);
-        exit(1);
+    if (daemon_mode) {
+        if (!socket_path || file_paths || files_from || batch_server) {
+            usage(stderr, argv[0]);
+            exit(1);
+        }
+
+        exit(daemon_serve(socket_path, idle_timeout));
     }
 
-    /* Go through all the files in the argument list */
-    for (i = 0; i < path_count; ++i) {
+    if (batch_server) {
+        if (file_paths || files_from) {
+            usage(stderr, argv[0]);
+            exit(1);
+        }
+
+        if (output_init(&out, 1, OUTPUT_BUFFER_SIZE) ||
+                input_init(&src.input, 0, delimiter, INPUT_BUFFER_SIZE))
+        {
+            perror("Unable to allocate memory");
+            exit(2);
+        }
 
-        int             j;
+        serve_batch(&src.input, conf_filename,
+                version_major, version_minor, version_patch);
 
-        full_filename = file_paths[i];
+        output_free(&out);
+        input_free(&src.input);
+        exit(0);
+    }
 
-        /* Print the file path first, with [], if more than one file is
-         * specified */
-        if (path_count > 1 && strcmp(full_filename, "-"))
-            printf("[%s]\n", full_filename);
+    if (walk_dir) {
+        size_t      len = strlen(walk_dir);
 
-        if (!strcmp(full_filename, "-")) {
-            int             len;
+        if (file_paths || files_from) {
+            usage(stderr, argv[0]);
+            exit(1);
+        }
+        /* there are no paths given, but there will be */
+        file_paths = &stdin_path;
+        path_count = 0;
+
+        /* the library needs full paths, and fts keeps trailing slashes */
+        while (len > 1 && walk_dir[len - 1] == '/')
+            -- len;
+        if (walk_dir[0] == '/')
+            walk_root = strndup(walk_dir, len);
+        else
+            walk_root = realpath(walk_dir, NULL);
+        if (walk_root == NULL)
+        {
+            perror(walk_dir);
+            exit(1);
+        }
+
+        if (walk_open(&walk, walk_root, follow_symlinks)) {
+            perror(walk_dir);
+            exit(1);
+        }
+    }
 
-            /* Read a line from stdin. If EOF encountered, continue */
-            if (!fgets(file_line_buffer, FILENAME_MAX + 1, stdin)) {
-                if (!feof(stdin))
-                    perror("Failed to read stdin");
+    if (files_from) {
+        /* the paths are read from the file, as if it were given as "-" */
+        if (file_paths) {
+            usage(stderr, argv[0]);
+            exit(1);
+        }
+        file_paths = &stdin_path;
+        path_count = 1;
 
-                free(full_filename);
-                continue;
+        if (strcmp(files_from, "-")) {
+            input_fd = open(files_from, O_RDONLY);
+            if (input_fd < 0) {
+                perror(files_from);
+                exit(1);
             }
+        }
+    }
 
-            -- i;
+    if (!file_paths) { /* No filename is set */ 
+        usage(stderr, argv[0]);
+        exit(1);
+    }
 
-            /* trim the trailing space characters */
-            len = strlen(file_line_buffer) - 1;
-            while (len >= 0 && isspace(file_line_buffer[len]))
-                -- len;
-            if (len < 0) /* we meet a blank line */
-                continue;
-            file_line_buffer[len + 1] = '\0';
+    if (output_init(&out, 1, OUTPUT_BUFFER_SIZE))
+    {
+        perror("Unable to allocate memory");
+        exit(2);
+    }
+    interactive = isatty(STDOUT_FILENO);
 
-            full_filename = file_line_buffer;
-            while (isspace(*full_filename))
-                ++ full_filename;
+    if (dedup_mode && dedup_init(&results))
+    {
+        perror("Unable to allocate memory");
+        exit(2);
+    }
 
-            full_filename = xstrdup(full_filename);
+    src.file_paths = file_paths;
+    src.path_count = path_count;
+    src.index = 0;
+    src.input_name = input_fd ? files_from : "stdin";
+    src.walk = walk_dir ? &walk : NULL;
+    if (input_init(&src.input, input_fd, delimiter, INPUT_BUFFER_SIZE))
+    {
+        perror("Unable to allocate memory");
+        exit(2);
+    }
 
-            printf("[%s]\n", full_filename);
-        }
+    if (profile_mode)
+        editorconfig_profile_set_enabled(1);
+    if (trace_path && trace_start(trace_path)) {
+        perror(trace_path);
+        exit(1);
+    }
 
-        /* Initialize the EditorConfig handle */
-        eh = editorconfig_handle_init();
+    if (bench_mode) {
+        bench_workload      workload;
+        bench_options       options;
 
-        if (eh == NULL)
+        if (bench_workload_init(&workload))
         {
-            perror("Unable to create EditorConfig handle");
-            exit(3);
+            perror("Unable to allocate memory");
+            exit(2);
         }
+        while ((full_filename = next_path(&src, &len, &show_header)) != NULL)
+            if (bench_workload_add(&workload, full_filename, len))
+            {
+                perror("Unable to allocate memory");
+                exit(2);
+            }
 
-        /* Set conf file name */
-        if (conf_filename)
-            editorconfig_handle_set_conf_file_name(eh, conf_filename);
-
-        /* Set the version to be compatible with */
-        editorconfig_handle_set_version(eh,
-                version_major, version_minor, version_patch);
+        options.conf_filename = conf_filename;
+        options.version_major = version_major;
+        options.version_minor = version_minor;
+        options.version_patch = version_patch;
+        options.thread_counts = thread_counts ? thread_counts : &job_count;
+        options.run_count = thread_counts ? run_count : 1;
 
-        /* parsing the editorconfig files */
-        err_num = editorconfig_parse(full_filename, eh);
-        free(full_filename);
-
-        if (err_num != 0) {
-            /* print error message */
-            fputs(editorconfig_get_error_msg(err_num), stderr);
-            if (err_num > 0)
-                fprintf(stderr, ":%d \"%s\"", err_num,
-                        editorconfig_handle_get_err_file(eh));
-            fprintf(stderr, "\n");
+        if (bench_run(&workload, &options, &out))
+        {
+            check_output(output_flush(&out));
+            perror("Benchmark failed");
             exit(1);
         }
 
-        /* print the result */
-        name_value_count = editorconfig_handle_get_name_value_count(eh);
-        for (j = 0; j < name_value_count; ++j) {
-            const char*         name;
-            const char*         value;
+        bench_workload_free(&workload);
+        free(thread_counts);
+    } else if (job_count > 1) {
+        resolve_parallel(&src, job_count, conf_filename,
+                version_major, version_minor, version_patch);
+    } else {
+        /* The same handle is used for all the files */
+        eh = create_handle(conf_filename,
+                version_major, version_minor, version_patch);
 
-            editorconfig_handle_get_name_value(eh, j, &name, &value);
-            printf("%s=%s\n", name, value);
+        /* Fall back to resolving here if no daemon is running */
+        if (socket_path)
+            daemon_client_connect(&client, socket_path);
+
+        /* Go through all the files in the argument list */
+        while ((full_filename = next_path(&src, &len, &show_header)) != NULL) {
+            err_num = resolve_path(eh, full_filename, show_header, &out);
+            if (err_num != 0)
+                report_error(err_num, eh);
+            if (stats_mode)
+                print_stats(eh, full_filename);
+            if (dedup_mode)
+                print_dedup(&out, eh, full_filename);
+            if (interactive)
+                check_output(output_flush(&out));
         }
 
+        daemon_client_close(&client);
+
         if (editorconfig_handle_destroy(eh) != 0) {
             fprintf(stderr, "Failed to destroy editorconfig_handle.\n");
             exit(1);
         }
     }
 
-    free(file_paths);
+    check_output(output_flush(&out));
+    output_free(&out);
+
+    if (trace_path && trace_finish()) {
+        perror(trace_path);
+        exit(1);
+    }
+    if (dump_cache_mode)
+        editorconfig_dump_caches(print_glob_cache_entry,
+                print_file_cache_entry, stderr);
+    if (profile_mode) {
+        fprintf(stderr, "%12s %10s %10s %10s  %s\n", "match_us", "attempts",
+                "matches", "max_us", "config [section]");
+        editorconfig_profile_dump(print_profile_entry, stderr);
+    }
+
+    input_free(&src.input);
+    if (walk_dir) {
+        walk_close(&walk);
+        free(walk_root);
+    }
+    free(walk.includes);
+    free(walk.excludes);
+    if (dedup_mode)
+        dedup_free(&results);
+    if (input_fd)
+        close(input_fd);
 
     exit(0);
 }
-
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "output.h"
+
+/*
+ * Write all of iov, going on after partial writes and interruptions.
+ */
+static int write_all(int fd, struct iovec* iov, int iov_count)
+{
+    while (iov_count > 0) {
+        ssize_t     written = writev(fd, iov, iov_count);
+
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        while (iov_count > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            ++ iov;
+            -- iov_count;
+        }
+        if (iov_count > 0) {
+            iov->iov_base = (char*)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * See header file
+ */
+int output_init(output_buffer* out, int fd, size_t size)
+{
+    out->fd = fd;
+    out->size = size;
+    out->used = 0;
+    out->buf = (char*)malloc(size);
+
+    return out->buf ? 0 : -1;
+}
+
+/*
+ * See header file
+ */
+void output_free(output_buffer* out)
+{
+    free(out->buf);
+    out->buf = NULL;
+    out->size = out->used = 0;
+}
+
+/*
+ * See header file
+ */
+char* output_reserve(output_buffer* out, size_t len)
+{
+    char*       room;
+    size_t      size;
+
+    if (out->size - out->used < len && out->fd >= 0 && output_flush(out))
+        return NULL;
+
+    if (out->size - out->used < len) {
+        char*   buf;
+
+        size = out->size * 2 > out->used + len ?
+            out->size * 2 : out->used + len;
+        buf = (char*)realloc(out->buf, size);
+        if (buf == NULL)
+            return NULL;
+        out->buf = buf;
+        out->size = size;
+    }
+
+    room = out->buf + out->used;
+    out->used += len;
+
+    return room;
+}
+
+/*
+ * See header file
+ */
+int output_write(output_buffer* out, const char* data, size_t len)
+{
+    struct iovec    iov[2];
+    char*           room;
+
+    if (out->size - out->used >= len || out->fd < 0) {
+        room = output_reserve(out, len);
+        if (room == NULL)
+            return -1;
+        memcpy(room, data, len);
+        return 0;
+    }
+
+    iov[0].iov_base = out->buf;
+    iov[0].iov_len = out->used;
+    iov[1].iov_base = (void*)data;
+    iov[1].iov_len = len;
+    out->used = 0;
+
+    return write_all(out->fd, iov, 2);
+}
+
+/*
+ * See header file
+ */
+int output_flush(output_buffer* out)
+{
+    struct iovec    iov;
+
+    if (out->used == 0 || out->fd < 0)
+        return 0;
+
+    iov.iov_base = out->buf;
+    iov.iov_len = out->used;
+    out->used = 0;
+
+    return write_all(out->fd, &iov, 1);
+}
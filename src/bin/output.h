@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Buffered output to a file descriptor. Everything written goes into one
+ * large buffer which is only handed to the kernel when it is full or when
+ * output_flush() is called, so printing a result costs a few memcpy() calls
+ * instead of a trip through stdio per line.
+ */
+
+#ifndef OUTPUT_H__
+#define OUTPUT_H__
+
+#include <stddef.h>
+
+/* the default size of the buffer */
+#define OUTPUT_BUFFER_SIZE      (256 * 1024)
+
+typedef struct
+{
+    int         fd;
+    char*       buf;
+    size_t      size;
+    size_t      used;
+} output_buffer;
+
+/*
+ * Set up out to write to fd through a buffer of size bytes. If fd is -1,
+ * nothing is written and the buffer grows instead, to collect output in
+ * memory. Returns 0 if successful, -1 if out of memory.
+ */
+int output_init(output_buffer* out, int fd, size_t size);
+
+/*
+ * Free the buffer of out without flushing it.
+ */
+void output_free(output_buffer* out);
+
+/*
+ * Return room for len bytes at the end of the buffer, flushing or growing it
+ * if needed. The caller fills the room in, it counts as written right away.
+ * Returns NULL on a write error or if out of memory.
+ */
+char* output_reserve(output_buffer* out, size_t len);
+
+/*
+ * Append len bytes of data. Data that does not fit is written together with
+ * the buffer in a single writev() call instead of being copied. Returns 0 if
+ * successful, -1 on a write error.
+ */
+int output_write(output_buffer* out, const char* data, size_t len);
+
+/*
+ * Write everything that is buffered. Returns 0 if successful, -1 on a write
+ * error.
+ */
+int output_flush(output_buffer* out);
+
+#endif /* !OUTPUT_H__ */
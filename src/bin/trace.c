@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "json.h"
+#include "trace.h"
+
+static FILE*            trace_file;
+/* whether an event was written, which the next one is separated from */
+static _Bool            trace_started;
+/* numbers the threads in the order they first do some work */
+static int              thread_count;
+static __thread int     thread_id;
+
+static void write_span(const editorconfig_trace_span* span, void* user)
+{
+    (void)user;
+
+    if (thread_id == 0)
+        thread_id = __atomic_add_fetch(&thread_count, 1, __ATOMIC_RELAXED);
+
+    /* the spans of all threads go to the same file */
+    flockfile(trace_file);
+    fprintf(trace_file, "%s{\"name\": \"%s\", \"cat\": \"editorconfig\", "
+            "\"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": %d, "
+            "\"tid\": %d, \"args\": {\"subject\": ",
+            trace_started ? ",\n" : "", span->name, span->start_ns / 1e3,
+            span->duration_ns / 1e3, (int)getpid(), thread_id);
+    json_print_string(trace_file, span->subject);
+    fputs("}}", trace_file);
+    trace_started = 1;
+    funlockfile(trace_file);
+}
+
+/*
+ * See header file
+ */
+int trace_start(const char* path)
+{
+    trace_file = fopen(path, "w");
+    if (trace_file == NULL)
+        return -1;
+
+    fputs("{\"traceEvents\": [\n", trace_file);
+    editorconfig_set_trace_callback(write_span, NULL);
+    return 0;
+}
+
+/*
+ * See header file
+ */
+int trace_finish(void)
+{
+    int     err;
+
+    editorconfig_set_trace_callback(NULL, NULL);
+    fputs("\n], \"displayTimeUnit\": \"ns\"}\n", trace_file);
+    err = ferror(trace_file);
+    if (fclose(trace_file) != 0)
+        err = 1;
+    trace_file = NULL;
+
+    return err ? -1 : 0;
+}
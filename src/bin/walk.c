@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include <errno.h>
+#include <fnmatch.h>
+#include <string.h>
+
+#include "walk.h"
+
+/*
+ * Files before directories, then by name.
+ */
+static int compare_entries(const FTSENT** a, const FTSENT** b)
+{
+    int     a_dir = (*a)->fts_info == FTS_D;
+    int     b_dir = (*b)->fts_info == FTS_D;
+
+    if (a_dir != b_dir)
+        return a_dir - b_dir;
+
+    return strcmp((*a)->fts_name, (*b)->fts_name);
+}
+
+/*
+ * Whether ent matches one of patterns. Patterns with a slash are matched
+ * against the path relative to the root, others against the name only.
+ */
+static _Bool matches(const walk_state* walk, const FTSENT* ent,
+        const char** patterns, int pattern_count)
+{
+    const char*     relative = ent->fts_path + walk->root_len;
+    int             i;
+
+    while (*relative == '/')
+        ++ relative;
+
+    for (i = 0; i < pattern_count; ++i) {
+        if (strchr(patterns[i], '/') ?
+                !fnmatch(patterns[i], relative, FNM_PATHNAME) :
+                !fnmatch(patterns[i], ent->fts_name, 0))
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * See header file
+ */
+int walk_open(walk_state* walk, const char* dir, _Bool follow_symlinks)
+{
+    char*       roots[2];
+
+    roots[0] = (char*)dir;
+    roots[1] = NULL;
+
+    walk->root_len = strlen(dir);
+    walk->fts = fts_open(roots,
+            (follow_symlinks ? FTS_LOGICAL : FTS_PHYSICAL) | FTS_NOCHDIR,
+            compare_entries);
+
+    return walk->fts ? 0 : -1;
+}
+
+/*
+ * See header file
+ */
+const char* walk_next(walk_state* walk, size_t* len)
+{
+    FTSENT*     ent;
+
+    while ((ent = fts_read(walk->fts)) != NULL) {
+        switch (ent->fts_info) {
+        case FTS_D:
+            if (ent->fts_level > 0 &&
+                    matches(walk, ent, walk->excludes, walk->exclude_count))
+                fts_set(walk->fts, ent, FTS_SKIP);
+            else if (walk->max_depth >= 0 &&
+                    ent->fts_level >= walk->max_depth)
+                fts_set(walk->fts, ent, FTS_SKIP);
+            break;
+
+        case FTS_F:
+            if (matches(walk, ent, walk->excludes, walk->exclude_count))
+                break;
+            if (walk->include_count > 0 &&
+                    !matches(walk, ent, walk->includes, walk->include_count))
+                break;
+            *len = ent->fts_pathlen;
+            return ent->fts_path;
+
+        case FTS_DNR:
+        case FTS_ERR:
+        case FTS_NS:
+            if (walk->warn)
+                walk->warn(ent->fts_path, ent->fts_errno);
+            break;
+
+        default:
+            /* directories on the way back up, symbolic links that are not
+             * followed, and anything that is not a regular file */
+            break;
+        }
+    }
+
+    if (errno != 0 && walk->warn)
+        walk->warn("fts_read", errno);
+
+    return NULL;
+}
+
+/*
+ * See header file
+ */
+void walk_close(walk_state* walk)
+{
+    if (walk->fts)
+        fts_close(walk->fts);
+    walk->fts = NULL;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Walks a directory tree for -r, yielding the regular files in it. The files
+ * of a directory come before its subdirectories, so that one handle resolves
+ * them one after another and reuses the editorconfig files it found for the
+ * first one.
+ */
+
+#ifndef WALK_H__
+#define WALK_H__
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <fts.h>
+
+typedef struct
+{
+    FTS*            fts;
+    /* the length of the root path, to match patterns against the paths
+     * relative to it */
+    size_t          root_len;
+    /* only files matching one of includes, if any, are yielded, and no file
+     * or directory matching one of excludes */
+    const char**    includes;
+    int             include_count;
+    const char**    excludes;
+    int             exclude_count;
+    /* how many levels of directories to go down, -1 for no limit */
+    int             max_depth;
+    /* called for files and directories that cannot be read */
+    void            (*warn)(const char* path, int err);
+} walk_state;
+
+/*
+ * Starts walking dir, which should be a full path. The patterns, max_depth
+ * and warn should be set before. Symbolic links are followed only if
+ * follow_symlinks is set, otherwise they are skipped. Returns 0 if
+ * successful, -1 with errno set otherwise.
+ */
+int walk_open(walk_state* walk, const char* dir, _Bool follow_symlinks);
+
+/*
+ * Returns the next regular file and sets len to the length of its path, or
+ * returns NULL at the end. The path is valid until the next call.
+ */
+const char* walk_next(walk_state* walk, size_t* len);
+
+void walk_close(walk_state* walk);
+
+#endif /* !WALK_H__ */
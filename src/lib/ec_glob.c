@@ -40,6 +40,8 @@
 #include "util.h"
 
 #include "ec_glob.h"
+#include "metrics.h"
+#include "probes.h"
 
 /* Special characters */
 const char ec_special_chars[] = "?[]\\*-{},";
@@ -51,11 +53,12 @@ typedef struct int_pair
 } int_pair;
 static const UT_icd ut_int_pair_icd = {sizeof(int_pair),NULL,NULL,NULL};
 
-/* concatenate the string then move the pointer to the end */
+/* concatenate the string then move the pointer to the end, giving up on
+ * compiling the pattern if it does not fit */
 #define STRING_CAT(p, string, end)  do {    \
     size_t string_len = strlen(string); \
     if (p + string_len >= end) \
-        return -1; \
+        goto compile_failed; \
     strcat(p, string); \
     p += string_len; \
 } while(0)
@@ -95,16 +98,24 @@ pcre2_code* ec_glob_number_pattern(void)
     return NULL;
 }
 
-typedef std::pair<uint8_t *, UT_array*>  ec_glob_cache_pair;
+typedef struct ec_glob_cache_entry
+{
+    uint8_t     *data = NULL;       /* the serialized expression */
+    UT_array    *nums = NULL;       /* its number ranges */
+    size_t      size = 0;           /* the size of the compiled expression */
+    uint64_t    hits = 0;
+    uint64_t    lastUse = 0;        /* ec_coarse_now_ns() */
+    bool        failed = false;     /* the pattern does not compile */
+} ec_glob_cache_entry;
 
-static std::pair<pcre2_code*, UT_array *>
-ec_glob_cached_pattern(const char *pattern, pcre2_code *re /* NULL to fetch, otherwise to store */, UT_array *nums /* ignored for fetch */)
+static dispatch_once_t  _inited;
+static std::map<std::string, ec_glob_cache_entry>
+                        *_map;
+static pthread_mutex_t  _mutex;
+
+static void
+ec_glob_cache_init(void)
 {
-    static dispatch_once_t  _inited;
-    static std::map<std::string, ec_glob_cache_pair>
-                            *_map;
-    static pthread_mutex_t  _mutex;
-    
     dispatch_once(&_inited,
         ^()
         {
@@ -117,9 +128,19 @@ ec_glob_cached_pattern(const char *pattern, pcre2_code *re /* NULL to fetch, oth
             
             pthread_mutexattr_destroy(&mutexAttrs);
         
-            _map = new std::map<std::string, ec_glob_cache_pair>();
+            _map = new std::map<std::string, ec_glob_cache_entry>();
         }
     );
+}
+
+//  storing takes over nums: the cache keeps it, or frees it and returns the
+//  one it already had when another lookup stored the pattern first. If the
+//  pattern could not be cached, the caller keeps nums.
+static std::pair<pcre2_code*, UT_array *>
+ec_glob_cached_pattern(const char *pattern, pcre2_code *re /* NULL to fetch, otherwise to store */, UT_array *nums /* ignored for fetch */,
+                       bool *failed /* set on fetch if the pattern is known not to compile */)
+{
+    ec_glob_cache_init();
     
     if ((NULL == pattern) || (0 == *pattern))
     {
@@ -127,21 +148,33 @@ ec_glob_cached_pattern(const char *pattern, pcre2_code *re /* NULL to fetch, oth
         /*...*/
     }
     else
-    if (0 == pthread_mutex_lock(&_mutex))
+    if (0 == EC_METRIC_LOCK(&_mutex, glob_cache_lock))
     {
         if (NULL == re)
         {
             //  we're going to fetch
-            ec_glob_cache_pair entry = (*_map)[pattern];
+            ec_glob_cache_entry &entry = (*_map)[pattern];
             
-            if (NULL != entry.first)
+            if (entry.failed)
             {
-                if (1 == pcre2_serialize_decode(&re, 1, entry.first, NULL))
+                ++ entry.hits;
+                entry.lastUse = ec_coarse_now_ns();
+                *failed = true;
+            }
+            else
+            if (NULL != entry.data)
+            {
+                if (1 == pcre2_serialize_decode(&re, 1, entry.data, NULL))
                 {
+                    UT_array    *nums = entry.nums;
+                    
+                    ++ entry.hits;
+                    entry.lastUse = ec_coarse_now_ns();
+                    
                 	//	We are good to go, release our lock and return
 			        pthread_mutex_unlock(&_mutex);
                 
-                    return std::pair<pcre2_code *, UT_array *>(re, entry.second);
+                    return std::pair<pcre2_code *, UT_array *>(re, nums);
 				}
             }
         }
@@ -151,9 +184,30 @@ ec_glob_cached_pattern(const char *pattern, pcre2_code *re /* NULL to fetch, oth
             
             uint8_t     *data = NULL;
             PCRE2_SIZE  dataSize;
+            ec_glob_cache_entry &entry = (*_map)[pattern];
+            
+            if (NULL != entry.data)
+            {
+                //  another lookup compiled it at the same time, keep theirs
+                UT_array    *cachedNums = entry.nums;
+                
+                utarray_free(nums);
+                pthread_mutex_unlock(&_mutex);
+                
+                return std::pair<pcre2_code *, UT_array *>(NULL, cachedNums);
+            }
             
             if (1 == pcre2_serialize_encode((const pcre2_code**)&re, 1, &data, &dataSize, NULL))
-                (*_map)[pattern] = ec_glob_cache_pair(data, nums);
+            {
+                entry.data = data;
+                entry.nums = nums;
+                pcre2_pattern_info(re, PCRE2_INFO_SIZE, &entry.size);
+                entry.lastUse = ec_coarse_now_ns();
+                
+                pthread_mutex_unlock(&_mutex);
+                
+                return std::pair<pcre2_code *, UT_array *>(NULL, nums);
+            }
         }
         
         pthread_mutex_unlock(&_mutex);
@@ -162,13 +216,104 @@ ec_glob_cached_pattern(const char *pattern, pcre2_code *re /* NULL to fetch, oth
     return std::pair<pcre2_code *, UT_array *>(NULL, NULL);
 }
 
+//  remember that pattern does not compile, so that lookups don't try again,
+//  and so that lookups from the cache only know the answer.
+static void
+ec_glob_cache_failure(const char *pattern)
+{
+    ec_glob_cache_init();
+    
+    if (0 == EC_METRIC_LOCK(&_mutex, glob_cache_lock))
+    {
+        ec_glob_cache_entry &entry = (*_map)[pattern];
+        
+        entry.failed = true;
+        entry.lastUse = ec_coarse_now_ns();
+        
+        pthread_mutex_unlock(&_mutex);
+    }
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+size_t ec_glob_cache_count(void)
+{
+    size_t  count = 0;
+    
+    ec_glob_cache_init();
+    
+    if (0 == pthread_mutex_lock(&_mutex))
+    {
+        //  fetching a pattern that is not there leaves an empty entry
+        for (std::map<std::string, ec_glob_cache_entry>::const_iterator it = _map->begin(); it != _map->end(); ++it)
+            if ((NULL != it->second.data) || it->second.failed)
+                ++ count;
+        
+        pthread_mutex_unlock(&_mutex);
+    }
+    
+    return count;
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+void ec_glob_cache_clear(void)
+{
+    ec_glob_cache_init();
+    
+    if (0 == pthread_mutex_lock(&_mutex))
+    {
+        for (std::map<std::string, ec_glob_cache_entry>::iterator it = _map->begin(); it != _map->end(); ++it)
+        {
+            if ((NULL != it->second.data) || it->second.failed)
+                EC_METRIC_INC(glob_cache_evictions);
+            if (NULL != it->second.data)
+                pcre2_serialize_free(it->second.data);
+            if (NULL != it->second.nums)
+                utarray_free(it->second.nums);
+        }
+        _map->clear();
+        
+        pthread_mutex_unlock(&_mutex);
+    }
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+void ec_glob_cache_dump(editorconfig_glob_cache_visitor visit, void* user)
+{
+    ec_glob_cache_init();
+    
+    if (0 == pthread_mutex_lock(&_mutex))
+    {
+        uint64_t    now = ec_coarse_now_ns();
+        
+        for (std::map<std::string, ec_glob_cache_entry>::const_iterator it = _map->begin(); it != _map->end(); ++it)
+        {
+            editorconfig_glob_cache_entry   entry;
+            
+            if ((NULL == it->second.data) && ! it->second.failed)
+                continue;
+            
+            entry.pattern = it->first.c_str();
+            entry.compiled_size = it->second.size;
+            entry.hits = it->second.hits;
+            entry.idle_ns = now - it->second.lastUse;
+            visit(&entry, user);
+        }
+        
+        pthread_mutex_unlock(&_mutex);
+    }
+}
+
 #define PATTERN_MAX  4097
 /*
  * Whether the string matches the given glob pattern. Return 0 if successful, return -1 if a PCRE
- * error or other regex error occurs, and return -2 if an OOM outside PCRE occurs.
+ * error or other regex error occurs, and return -2 if an OOM outside PCRE occurs. With
+ * EC_GLOB_CACHE_ONLY in flags, return EC_GLOB_NOT_CACHED instead of compiling the pattern.
  */
 EDITORCONFIG_LOCAL
-int ec_glob(const char *pattern, const char *string)
+int ec_glob(const char *pattern, const char *string, int flags)
 {
     size_t                    i;
     int_pair *                p;
@@ -187,17 +332,41 @@ int ec_glob(const char *pattern, const char *string)
     char                      l_pattern[2 * PATTERN_MAX];
     bool                      are_braces_paired = 1;
     UT_array *                nums = NULL;     /* number ranges */
+    UT_array *                uncached_nums = NULL;
     std::pair<pcre2_code *, UT_array *>
                               cached((pcre2_code*)NULL, (UT_array*)NULL);
     int                       ret = 0;
+    bool                      failed = 0;      /* known not to compile */
+    bool                      transient = 0;   /* failed for lack of memory */
+    uint64_t                  compile_start = 0;
+    uint64_t                  match_start = 0;
+    uint64_t                  trace_start = 0;
 
     strcpy(l_pattern, pattern);
     p_pcre = pcre_str + 1;
     pcre_str_end = pcre_str + 2 * PATTERN_MAX;
 
-    cached = ec_glob_cached_pattern(pattern, NULL, NULL);
+    cached = ec_glob_cached_pattern(pattern, NULL, NULL, &failed);
+    if (failed)
+    {
+        EC_METRIC_INC(glob_cache_hits);
+        EC_PROBE1(glob__cache__hit, pattern);
+        EC_QUERY_INC(glob_cache_hits);
+        return -1;
+    }
+    
     if (NULL == (re = cached.first))
     {
+        EC_METRIC_INC(glob_cache_misses);
+        EC_PROBE1(glob__cache__miss, pattern);
+        EC_QUERY_INC(glob_cache_misses);
+        
+        if (flags & EC_GLOB_CACHE_ONLY)
+            return EC_GLOB_NOT_CACHED;
+        
+        EC_PROBE1(glob__compile__start, pattern);
+        compile_start = EC_QUERY_CLOCK();
+        trace_start = EC_TRACE_CLOCK();
     
         /* Determine whether curly braces are paired */
         {
@@ -229,7 +398,10 @@ int ec_glob(const char *pattern, const char *string)
     
         /* used to search for {num1..num2} case */
         if (NULL == (re = ec_glob_number_pattern()))
-            return -1;        /* failed to compile */
+        {
+            transient = 1;
+            goto compile_failed;
+        }
     
         utarray_new(nums, &ut_int_pair_icd);
     
@@ -447,25 +619,36 @@ int ec_glob(const char *pattern, const char *string)
     
         re = pcre2_compile((PCRE2_SPTR8)pcre_str, PCRE2_ZERO_TERMINATED, 0, &error_code, &erroffset, NULL);
     
-        if (NULL != re)
+        if (NULL == re)
         {
-            //  cache it so that we don't have to do this again.
-            //	Note that "nums" gets cached, so we only free it
-            //	in the error case.
-            ec_glob_cached_pattern(pattern, re, nums);
+            transient = (PCRE2_ERROR_HEAP_FAILED == error_code);
+            goto compile_failed;
         }
+        
+        //  cache it so that we don't have to do this again.
+        //	Note that "nums" gets cached, so we only free it
+        //	in the error case, or if it couldn't be cached.
+        cached = ec_glob_cached_pattern(pattern, re, nums, NULL);
+        if (NULL == cached.second)
+            uncached_nums = nums;
         else
-        {
-            /* failed to compile */
-            utarray_free(nums);
-            return -1;
-        }
+            nums = cached.second;
+        EC_PROBE2(glob__compile__done, pattern, 1);
+        EC_QUERY_INC(glob_compiles);
+        EC_QUERY_ELAPSED(glob_compile_ns, compile_start);
+        EC_TRACE_SPAN("glob_compile", pattern, trace_start);
     }
     else
     {
+        EC_METRIC_INC(glob_cache_hits);
+        EC_PROBE1(glob__cache__hit, pattern);
+        EC_QUERY_INC(glob_cache_hits);
         nums = cached.second;
     }
     
+    EC_PROBE2(glob__match__start, pattern, string);
+    match_start = EC_QUERY_CLOCK();
+    trace_start = EC_TRACE_CLOCK();
     pcre_match_data = pcre2_match_data_create_from_pattern(re, NULL);
     rc = pcre2_match(re, (PCRE2_SPTR8)string, strlen(string), 0, 0, pcre_match_data, NULL);
 
@@ -510,8 +693,29 @@ int ec_glob(const char *pattern, const char *string)
 
  cleanup:
 
+    EC_PROBE3(glob__match__done, pattern, string, ret);
+    EC_QUERY_INC(glob_matches);
+    EC_QUERY_ELAPSED(glob_match_ns, match_start);
+    EC_TRACE_SPAN("glob_match", pattern, trace_start);
     pcre2_code_free(re);
     pcre2_match_data_free(pcre_match_data);
+    if (NULL != uncached_nums)
+        utarray_free(uncached_nums);
 
     return ret;
+
+ compile_failed:
+
+    /* the pattern does not compile, or is too long to */
+    EC_PROBE2(glob__compile__done, pattern, 0);
+    EC_QUERY_INC(glob_compiles);
+    EC_QUERY_ELAPSED(glob_compile_ns, compile_start);
+    EC_TRACE_SPAN("glob_compile", pattern, trace_start);
+    pcre2_code_free(re);    /* the number pattern, if STRING_CAT gave up */
+    if (NULL != nums)
+        utarray_free(nums);
+    if (! transient)
+        ec_glob_cache_failure(pattern);
+
+    return -1;
 }
@@ -29,13 +29,31 @@
 
 #include "global.h"
 
-#define EC_GLOB_NOMATCH  1   /* Match failed. */
+#include <editorconfig/editorconfig.h>
+
+#define EC_GLOB_NOMATCH     1   /* Match failed. */
+#define EC_GLOB_NOT_CACHED  2   /* Pattern is not compiled yet. */
+
+/* Flags for ec_glob(). */
+#define EC_GLOB_CACHE_ONLY  0x1 /* Don't compile, fail with EC_GLOB_NOT_CACHED. */
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 EDITORCONFIG_LOCAL
-int ec_glob(const char * pattern, const char * string);
+int ec_glob(const char * pattern, const char * string, int flags);
+
+/* The count of compiled patterns in the cache. */
+EDITORCONFIG_LOCAL
+size_t ec_glob_cache_count(void);
+
+/* Forget all compiled patterns. No ec_glob() call may be running. */
+EDITORCONFIG_LOCAL
+void ec_glob_cache_clear(void);
+
+/* Call visit for each compiled pattern, with the lock of the cache held. */
+EDITORCONFIG_LOCAL
+void ec_glob_cache_dump(editorconfig_glob_cache_visitor visit, void* user);
 
 /* Special characters. */
 extern const char ec_special_chars[];
@@ -29,6 +29,11 @@
 #include "misc.h"
 #include "ini.h"
 #include "ec_glob.h"
+#include "intern.h"
+#include "loader.h"
+#include "metrics.h"
+#include "probes.h"
+#include "profile.h"
 
 /* could be used to fast locate these properties in an
  * array_editorconfig_name_value */
@@ -50,8 +55,18 @@ typedef struct
 typedef struct
 {
     char*                           full_filename;
-    char*                           editorconfig_file_dir;
+    /* the directory of the editorconfig file being parsed, escaped for use in
+     * a glob pattern */
+    const char*                     editorconfig_dir_pattern;
+    /* the editorconfig file being parsed */
+    const char*                     config_file;
     array_editorconfig_name_value   array_name_value;
+    /* flags passed to ec_glob() */
+    int                             glob_flags;
+    /* set when EC_GLOB_CACHE_ONLY is given and a pattern is not compiled */
+    _Bool                           not_cached;
+    /* set when the matches are profiled */
+    _Bool                           profile;
 } handler_first_param;
 
 /*
@@ -61,36 +76,46 @@ static void set_special_property_name_value_pointers(
         const editorconfig_name_value* nv,
         special_property_name_value_pointers* spnvp)
 {
-    /* set speical pointers */
-    if (!strcmp(nv->name, "indent_style"))
+    /* set speical pointers; names are interned, so comparing the pointers is
+     * enough */
+    if (nv->name == ec_known_names[EC_NAME_INDENT_STYLE])
         spnvp->indent_style = nv;
-    else if (!strcmp(nv->name, "indent_size"))
+    else if (nv->name == ec_known_names[EC_NAME_INDENT_SIZE])
         spnvp->indent_size = nv;
-    else if (!strcmp(nv->name, "tab_width"))
+    else if (nv->name == ec_known_names[EC_NAME_TAB_WIDTH])
         spnvp->tab_width = nv;
 }
 
 /*
- * Set the name and value of a editorconfig_name_value structure
+ * Set the name and value of a editorconfig_name_value structure. name must be
+ * interned already and is taken over, value is interned here. Returns -1 if
+ * out of memory.
  */
-static void set_name_value(editorconfig_name_value* nv, const char* name,
+static int set_name_value(editorconfig_name_value* nv, const char* name,
         const char* value, special_property_name_value_pointers* spnvp)
 {
     if (name)
-        nv->name = strdup(name);
-    if (value)
-        nv->value = strdup(value);
-    /* lowercase the value when the name is one of the following */
-    if (!strcmp(nv->name, "end_of_line") ||
-            !strcmp(nv->name, "indent_style") ||
-            !strcmp(nv->name, "indent_size") ||
-            !strcmp(nv->name, "insert_final_newline") ||
-            !strcmp(nv->name, "trim_trailing_whitespace") ||
-            !strcmp(nv->name, "charset"))
-        strlwr(nv->value);
+        nv->name = name;
+    if (value) {
+        /* lowercase the value when the name is one of the following */
+        if (nv->name == ec_known_names[EC_NAME_END_OF_LINE] ||
+                nv->name == ec_known_names[EC_NAME_INDENT_STYLE] ||
+                nv->name == ec_known_names[EC_NAME_INDENT_SIZE] ||
+                nv->name == ec_known_names[EC_NAME_INSERT_FINAL_NEWLINE] ||
+                nv->name == ec_known_names[EC_NAME_TRIM_TRAILING_WHITESPACE] ||
+                nv->name == ec_known_names[EC_NAME_CHARSET])
+            nv->value = ec_intern_lower(value, strlen(value));
+        else
+            nv->value = ec_intern(value, strlen(value));
+
+        if (nv->value == NULL)
+            return -1;
+    }
 
     /* set special pointers */
     set_special_property_name_value_pointers(nv, spnvp);
+
+    return 0;
 }
 
 /*
@@ -116,7 +141,7 @@ static int find_name_value_from_name(const editorconfig_name_value* env,
     int         i;
 
     for (i = 0; i < count; ++i)
-        if (!strcmp(env[i].name, name)) /* found */
+        if (env[i].name == name) /* found; names are interned */
             return i;
 
     return -1;
@@ -138,7 +163,7 @@ static int array_editorconfig_name_value_add(
     int         name_value_pos;
     /* always use name_lwr but not name, since property names are case
      * insensitive */
-    char        name_lwr[MAX_PROPERTY_NAME+1] = {0};
+    const char* name_lwr;
     /* For the first time we came here, aenv->name_values is NULL */
     if (aenv->name_values == NULL) {
         aenv->name_values = (editorconfig_name_value*)malloc(
@@ -153,16 +178,22 @@ static int array_editorconfig_name_value_add(
 
 
     /* name_lwr is the lowercase property name */
-    strlwr(strncpy(name_lwr, name, MAX_PROPERTY_NAME));
+    name_lwr = ec_intern_lower(name, strnlen(name, MAX_PROPERTY_NAME));
+    if (name_lwr == NULL)
+        return -1;
 
     name_value_pos = find_name_value_from_name(
             aenv->name_values, aenv->current_value_count, name_lwr);
 
     if (name_value_pos >= 0) { /* current name has already been used */
-        free(aenv->name_values[name_value_pos].value);
-        set_name_value(&aenv->name_values[name_value_pos],
+        const char* old_value = aenv->name_values[name_value_pos].value;
+        int         err;
+
+        ec_intern_release(name_lwr);
+        err = set_name_value(&aenv->name_values[name_value_pos],
                 (const char*)NULL, value, &aenv->spnvp);
-        return 0;
+        ec_intern_release(old_value);
+        return err;
     }
 
     /* if the space is not enough, allocate more before add the new name and
@@ -177,8 +208,10 @@ static int array_editorconfig_name_value_add(
         new_values = (editorconfig_name_value*)realloc(aenv->name_values,
                 sizeof(editorconfig_name_value) * new_max_value_count);
 
-        if (new_values == NULL) /* error occured */
+        if (new_values == NULL) { /* error occured */
+            ec_intern_release(name_lwr);
             return -1;
+        }
 
         aenv->name_values = new_values;
         aenv->max_value_count = new_max_value_count;
@@ -187,8 +220,11 @@ static int array_editorconfig_name_value_add(
         reset_special_property_name_value_pointers(aenv);
     }
 
-    set_name_value(&aenv->name_values[aenv->current_value_count],
-            name_lwr, value, &aenv->spnvp);
+    if (set_name_value(&aenv->name_values[aenv->current_value_count],
+            name_lwr, value, &aenv->spnvp)) {
+        ec_intern_release(name_lwr);
+        return -1;
+    }
     ++ aenv->current_value_count;
 
     return 0;
@@ -201,14 +237,70 @@ static void array_editorconfig_name_value_clear(
 {
     int             i;
 
+    /* the names and values themselves are interned */
     for (i = 0; i < aenv->current_value_count; ++i) {
-        free(aenv->name_values[i].name);
-        free(aenv->name_values[i].value);
+        ec_intern_release(aenv->name_values[i].name);
+        ec_intern_release(aenv->name_values[i].value);
     }
 
     free(aenv->name_values);
 }
 
+/*
+ * Store the names and values of aenv in the result block of eh, replacing
+ * the previous result. Returns 0 if successful, or
+ * EDITORCONFIG_PARSE_MEMORY_ERROR.
+ */
+static int editorconfig_result_pack(struct editorconfig_handle* eh,
+        const array_editorconfig_name_value* aenv)
+{
+    struct editorconfig_result_entry*   entries;
+    size_t                              size;
+    char*                               p;
+    int                                 i;
+
+    free(eh->result);
+    eh->result = NULL;
+    eh->result_size = 0;
+    eh->name_value_count = 0;
+
+    if (aenv->current_value_count == 0)
+        return 0;
+
+    size = sizeof(struct editorconfig_result_entry) *
+        aenv->current_value_count;
+    for (i = 0; i < aenv->current_value_count; ++i)
+        size += strlen(aenv->name_values[i].name) + 1 +
+            strlen(aenv->name_values[i].value) + 1;
+
+    eh->result = (char*)malloc(size);
+    if (eh->result == NULL)
+        return EDITORCONFIG_PARSE_MEMORY_ERROR;
+
+    entries = (struct editorconfig_result_entry*)eh->result;
+    p = eh->result +
+        sizeof(struct editorconfig_result_entry) * aenv->current_value_count;
+    for (i = 0; i < aenv->current_value_count; ++i) {
+        size_t      name_len = strlen(aenv->name_values[i].name);
+        size_t      value_len = strlen(aenv->name_values[i].value);
+
+        entries[i].name_offset = (uint32_t)(p - eh->result);
+        entries[i].name_length = (uint32_t)name_len;
+        memcpy(p, aenv->name_values[i].name, name_len + 1);
+        p += name_len + 1;
+
+        entries[i].value_offset = (uint32_t)(p - eh->result);
+        entries[i].value_length = (uint32_t)value_len;
+        memcpy(p, aenv->name_values[i].value, value_len + 1);
+        p += value_len + 1;
+    }
+
+    eh->result_size = size;
+    eh->name_value_count = aenv->current_value_count;
+
+    return 0;
+}
+
 /*
  * Accept INI property value and store known values in handler_first_param
  * struct.
@@ -219,6 +311,12 @@ static int ini_handler(void* hfp, const char* section, const char* name,
     handler_first_param* hfparam = (handler_first_param*)hfp;
     /* prepend ** to pattern */
     char*                pattern;
+    int                  glob_err;
+    uint64_t             match_start = 0;
+
+    /* the result is going to be thrown away anyway */
+    if (hfparam->not_cached)
+        return 1;
 
     /* root = true, clear all previous values */
     if (*section == '\0' && !strcasecmp(name, "root") &&
@@ -233,29 +331,16 @@ static int ini_handler(void* hfp, const char* section, const char* name,
      * if section starts with a '/', or /dir/of/editorconfig/file/[section] if
      * section contains '/' but does not start with '/'.
      *
-     * If the dir part has any special characters as defined by ec_glob.c, we
-     * need to escape them.
+     * The dir part has had the special characters as defined by ec_glob.c
+     * escaped already.
      */
     pattern = (char*)malloc(
-        /* The 2 here is for possible escaping. */
-        strlen(hfparam->editorconfig_file_dir) * sizeof(char) * 2 +
+        strlen(hfparam->editorconfig_dir_pattern) * sizeof(char) +
             sizeof("**/") + strlen(section) * sizeof(char));
     if (!pattern)
         return 0;
 
-    /* Escaping special characters in the directory part. */
-    char* ptr = hfparam->editorconfig_file_dir;
-    char* ptr_prev = ptr;
-    char* ptr_pattern = pattern;
-    for (; (ptr = strpbrk(ptr, ec_special_chars)) != NULL; ++ ptr, ptr_prev = ptr)
-    {
-        ptrdiff_t s = ptr - ptr_prev;
-        memcpy(ptr_pattern, ptr_prev, s * sizeof(char));
-        ptr_pattern += s;
-        *(ptr_pattern ++) = '\\';  /* escaping char */
-        *(ptr_pattern ++) = *ptr;
-    }
-    strcpy(ptr_pattern, ptr_prev);
+    strcpy(pattern, hfparam->editorconfig_dir_pattern);
 
     if (strchr(section, '/') == NULL) /* No / is found, append '[star][star]/' */
         strcat(pattern, "**/");
@@ -265,13 +350,20 @@ static int ini_handler(void* hfp, const char* section, const char* name,
 
     strcat(pattern, section);
 
-    if (ec_glob(pattern, hfparam->full_filename) == 0) {
+    if (hfparam->profile)
+        match_start = ec_now_ns();
+    glob_err = ec_glob(pattern, hfparam->full_filename, hfparam->glob_flags);
+    if (hfparam->profile && glob_err != EC_GLOB_NOT_CACHED)
+        ec_profile_record(hfparam->config_file, section, glob_err == 0,
+                ec_now_ns() - match_start);
+    if (glob_err == 0) {
         if (array_editorconfig_name_value_add(&hfparam->array_name_value, name,
                 value)) {
             free(pattern);
             return 0;
         }
-    }
+    } else if (glob_err == EC_GLOB_NOT_CACHED)
+        hfparam->not_cached = 1;
 
     free(pattern);
     return 1;
@@ -384,17 +476,84 @@ failure_cleanup:
 }
 
 /*
- * Free the memory used by an array of strings that was created by
- * get_filenames().
+ * Return a copy of dir with the characters that are special to ec_glob()
+ * escaped, or NULL if out of memory.
  */
-static void free_filenames(char **filenames)
+static char* escape_dir(const char* dir)
 {
-    if (filenames != NULL) {
-        for (char** filename = filenames; *filename != NULL; filename++) {
-            free(*filename);
-        }
-        free(filenames);
+    /* The 2 here is for possible escaping. */
+    char*           pattern = (char*)malloc(strlen(dir) * sizeof(char) * 2 + 1);
+    const char*     ptr = dir;
+    const char*     ptr_prev = ptr;
+    char*           ptr_pattern = pattern;
+
+    if (!pattern)
+        return NULL;
+
+    for (; (ptr = strpbrk(ptr, ec_special_chars)) != NULL; ++ ptr, ptr_prev = ptr)
+    {
+        ptrdiff_t s = ptr - ptr_prev;
+        memcpy(ptr_pattern, ptr_prev, s * sizeof(char));
+        ptr_pattern += s;
+        *(ptr_pattern ++) = '\\';  /* escaping char */
+        *(ptr_pattern ++) = *ptr;
     }
+    strcpy(ptr_pattern, ptr_prev);
+
+    return pattern;
+}
+
+/*
+ * Make eh->config_files and eh->config_dir_patterns hold the editorconfig
+ * files that apply to full_filename. Those of the previous parse are kept if
+ * it was for a file in the same directory, so walking a directory only looks
+ * them up once. Returns -1 if an OOM error occurs. Otherwise returns 0.
+ */
+static int update_config_files(struct editorconfig_handle* eh,
+        const char* full_filename)
+{
+    const char*     slash = strrchr(full_filename, '/');
+    size_t          dir_len = slash ? (size_t)(slash - full_filename) : 0;
+    int             count;
+    int             i;
+
+    if (eh->config_files &&
+            !strcmp(eh->config_conf_file_name, eh->conf_file_name) &&
+            !strncmp(eh->config_dir, full_filename, dir_len) &&
+            eh->config_dir[dir_len] == '\0')
+        return 0;
+
+    editorconfig_handle_free_config_files(eh);
+
+    eh->config_dir = strndup(full_filename, dir_len);
+    eh->config_conf_file_name = strdup(eh->conf_file_name);
+    eh->config_files = get_filenames(full_filename, eh->conf_file_name);
+    if (!eh->config_dir || !eh->config_conf_file_name || !eh->config_files)
+        goto failure_cleanup;
+
+    for (count = 0; eh->config_files[count] != NULL; ++count)
+        ;
+    eh->config_dir_patterns = (char**)calloc(count + 1, sizeof(char*));
+    if (!eh->config_dir_patterns)
+        goto failure_cleanup;
+
+    for (i = 0; i < count; ++i) {
+        char*       dir;
+
+        if (split_file_path(&dir, NULL, eh->config_files[i]) == -1)
+            goto failure_cleanup;
+        eh->config_dir_patterns[i] = escape_dir(dir);
+        free(dir);
+        if (!eh->config_dir_patterns[i])
+            goto failure_cleanup;
+    }
+
+    return 0;
+
+failure_cleanup:
+
+    editorconfig_handle_free_config_files(eh);
+    return -1;
 }
 
 /*
@@ -440,25 +599,41 @@ const char* editorconfig_get_error_msg(int err_num)
         return "Memory error.";
     case EDITORCONFIG_PARSE_VERSION_TOO_NEW:
         return "Required version is greater than the current version.";
+    case EDITORCONFIG_PARSE_WOULD_BLOCK:
+        return "Result is not cached yet.";
+    case EDITORCONFIG_PARSE_INVALID_DATA:
+        return "Serialized result is invalid.";
+    case EDITORCONFIG_PARSE_INVALID_ARGUMENT:
+        return "Invalid argument.";
     }
 
     return "Unknown error.";
 }
 
 /*
- * See the header file for the use of this function
+ * Implementation of editorconfig_parse() and editorconfig_try_parse(). If
+ * cache_only is set, EDITORCONFIG_PARSE_WOULD_BLOCK is returned instead of
+ * reading a config file or compiling a glob.
  */
-EDITORCONFIG_EXPORT
-int editorconfig_parse(const char* full_filename, editorconfig_handle h)
+static int editorconfig_parse_internal(const char* full_filename,
+        editorconfig_handle h, _Bool cache_only)
 {
     handler_first_param                 hfp;
-    char**                              config_file;
-    char**                              config_files = NULL;
-    int                                 err_num = 0;
     int                                 i;
+    int                                 err_num = 0;
     struct editorconfig_handle*         eh = (struct editorconfig_handle*)h;
     struct editorconfig_version         cur_ver;
     struct editorconfig_version         tmp_ver;
+    uint64_t                            total_start = ec_now_ns();
+    /* the conf files looked for, once they are known */
+    const char* const*                  config_files = NULL;
+    editorconfig_query_stats*           stats;
+    uint64_t                            phase_start;
+    uint64_t                            trace_start;
+    uint64_t                            elapsed;
+
+    /* the statistics of the previous lookup don't describe this one */
+    eh->has_stats = 0;
 
     /* get current version */
     editorconfig_get_version(&cur_ver.major, &cur_ver.minor,
@@ -470,8 +645,10 @@ int editorconfig_parse(const char* full_filename, editorconfig_handle h)
             eh->ver.patch == 0)
         eh->ver = cur_ver;
 
-    if (editorconfig_compare_version(&eh->ver, &cur_ver) > 0)
-        return EDITORCONFIG_PARSE_VERSION_TOO_NEW;
+    if (editorconfig_compare_version(&eh->ver, &cur_ver) > 0) {
+        err_num = EDITORCONFIG_PARSE_VERSION_TOO_NEW;
+        goto done;
+    }
 
     if (eh->err_file) {
         free(eh->err_file);
@@ -483,19 +660,22 @@ int editorconfig_parse(const char* full_filename, editorconfig_handle h)
     if (!eh->conf_file_name)
         eh->conf_file_name = ".editorconfig";
 
-    if (eh->name_values) {
-        /* free name_values */
-        for (i = 0; i < eh->name_value_count; ++i) {
-            free(eh->name_values[i].name);
-            free(eh->name_values[i].value);
-        }
-        free(eh->name_values);
+    /* free the previous result */
+    free(eh->result);
+    eh->result = NULL;
+    eh->result_size = 0;
+    eh->name_value_count = 0;
 
-        eh->name_values = NULL;
-        eh->name_value_count = 0;
-    }
     memset(&hfp, 0, sizeof(hfp));
 
+    EC_PROBE1(query__start, full_filename);
+    /* the statistics are recorded in the handle also when only the process
+     * wide metrics or the slow query callback need them */
+    if (eh->stats_enabled || ec_slow_query_callback ||
+            __atomic_load_n(&ec_metrics_phase_timing, __ATOMIC_RELAXED)) {
+        memset(&eh->stats, 0, sizeof(eh->stats));
+        ec_query_stats = &eh->stats;
+    }
     hfp.full_filename = strdup(full_filename);
     if (hfp.full_filename == NULL) {
         err_num = EDITORCONFIG_PARSE_MEMORY_ERROR;
@@ -514,36 +694,56 @@ int editorconfig_parse(const char* full_filename, editorconfig_handle h)
 #endif
 
     array_editorconfig_name_value_init(&hfp.array_name_value);
+    if (cache_only)
+        hfp.glob_flags = EC_GLOB_CACHE_ONLY;
+    hfp.profile = __atomic_load_n(&ec_profile_enabled, __ATOMIC_RELAXED);
 
-    config_files = get_filenames(hfp.full_filename, eh->conf_file_name);
-    if (config_files == NULL) {
+    phase_start = EC_QUERY_CLOCK();
+    trace_start = EC_TRACE_CLOCK();
+    if (update_config_files(eh, hfp.full_filename)) {
         err_num = EDITORCONFIG_PARSE_MEMORY_ERROR;
         goto cleanup;
     }
-    for (config_file = config_files; *config_file != NULL; config_file++) {
+    EC_QUERY_ELAPSED(discover_ns, phase_start);
+    EC_TRACE_SPAN("discover", full_filename, trace_start);
+    config_files = (const char* const*)eh->config_files;
+    for (i = 0; eh->config_files[i] != NULL; ++i) {
+        const char* config_file = eh->config_files[i];
         int ini_err_num;
-        err_num = split_file_path(&hfp.editorconfig_file_dir, NULL, *config_file);
-        if (err_num == -1) {
-          err_num = EDITORCONFIG_PARSE_MEMORY_ERROR;
-          goto cleanup;
+
+        hfp.editorconfig_dir_pattern = eh->config_dir_patterns[i];
+        hfp.config_file = config_file;
+        EC_PROBE2(config__discover, config_file, i);
+        EC_QUERY_INC(ancestors);
+
+        if (cache_only)
+            ini_err_num = ini_parse_cached(config_file, ini_handler, &hfp);
+        else
+            ini_err_num = ini_parse(config_file, ini_handler, &hfp);
+
+        if (hfp.not_cached || ini_err_num == INI_PARSE_NOT_CACHED) {
+            array_editorconfig_name_value_clear(&hfp.array_name_value);
+            err_num = EDITORCONFIG_PARSE_WOULD_BLOCK;
+            goto cleanup;
         }
 
-        if ((ini_err_num = ini_parse(*config_file, ini_handler, &hfp)) != 0 &&
+        if (ini_err_num != 0 &&
                 /* ignore error caused by I/O, maybe caused by non exist file */
                 ini_err_num != -1) {
             /* No need to specifically deal with the return value of the strdup
                of this line. If any error occurs for this strdup call,
                eh->err_file would simply be NULL.*/
-            eh->err_file = strdup(*config_file);
+            eh->err_file = strdup(config_file);
+            array_editorconfig_name_value_clear(&hfp.array_name_value);
             err_num = ini_err_num;
             goto cleanup;
         }
-
-        free(hfp.editorconfig_file_dir);
-        hfp.editorconfig_file_dir = NULL;
     }
 
     /* value proprocessing */
+    EC_PROBE1(merge__start, full_filename);
+    phase_start = EC_QUERY_CLOCK();
+    trace_start = EC_TRACE_CLOCK();
 
     /* For v0.9 */
     SET_EDITORCONFIG_VERSION(&tmp_ver, 0, 9, 0);
@@ -552,14 +752,16 @@ int editorconfig_parse(const char* full_filename, editorconfig_handle h)
      * indent_style is set to "tab". Only should be done after v0.9 */
         if (hfp.array_name_value.spnvp.indent_style &&
                 !hfp.array_name_value.spnvp.indent_size &&
-                !strcmp(hfp.array_name_value.spnvp.indent_style->value, "tab"))
+                hfp.array_name_value.spnvp.indent_style->value ==
+                ec_known_values[EC_VALUE_TAB])
             array_editorconfig_name_value_add(&hfp.array_name_value,
                     "indent_size", "tab");
     /* Set indent_size to tab_width if indent_size is "tab" and tab_width is
      * specified. This behavior is specified for v0.9 and up. */
         if (hfp.array_name_value.spnvp.indent_size &&
             hfp.array_name_value.spnvp.tab_width &&
-            !strcmp(hfp.array_name_value.spnvp.indent_size->value, "tab"))
+            hfp.array_name_value.spnvp.indent_size->value ==
+            ec_known_values[EC_VALUE_TAB])
         array_editorconfig_name_value_add(&hfp.array_name_value, "indent_size",
                 hfp.array_name_value.spnvp.tab_width->value);
     }
@@ -570,35 +772,106 @@ int editorconfig_parse(const char* full_filename, editorconfig_handle h)
     if (hfp.array_name_value.spnvp.indent_size &&
             !hfp.array_name_value.spnvp.tab_width &&
             (editorconfig_compare_version(&eh->ver, &tmp_ver) < 0 ||
-             strcmp(hfp.array_name_value.spnvp.indent_size->value, "tab")))
+             hfp.array_name_value.spnvp.indent_size->value !=
+             ec_known_values[EC_VALUE_TAB]))
         array_editorconfig_name_value_add(&hfp.array_name_value, "tab_width",
                 hfp.array_name_value.spnvp.indent_size->value);
 
-    eh->name_value_count = hfp.array_name_value.current_value_count;
-
-    if (eh->name_value_count == 0) {  /* no value is set, just return 0. */
-        free(hfp.full_filename);
-        free_filenames(config_files);
-        return 0;
-    }
-    eh->name_values = hfp.array_name_value.name_values;
-    eh->name_values = realloc(      /* realloc to truncate the unused spaces */
-            eh->name_values,
-            sizeof(editorconfig_name_value) * eh->name_value_count);
-    if (eh->name_values == NULL) {
-        free(hfp.full_filename);
-        free_filenames(config_files);
-        return EDITORCONFIG_PARSE_MEMORY_ERROR;
-    }
+    err_num = editorconfig_result_pack(eh, &hfp.array_name_value);
+    array_editorconfig_name_value_clear(&hfp.array_name_value);
+    EC_PROBE2(merge__done, full_filename, eh->name_value_count);
+    EC_QUERY_ELAPSED(merge_ns, phase_start);
+    EC_TRACE_SPAN("merge", full_filename, trace_start);
 
  cleanup:
-    free_filenames(config_files);
+    EC_PROBE2(query__done, full_filename, err_num);
     free(hfp.full_filename);
-    free(hfp.editorconfig_file_dir);
+
+ done:
+    elapsed = ec_now_ns() - total_start;
+    stats = ec_query_stats;
+    /* the slow query callback may do lookups of its own */
+    ec_query_stats = NULL;
+    if (stats) {
+        stats->total_ns = elapsed;
+        eh->has_stats = eh->stats_enabled;
+    }
+    ec_metrics_query_done(stats, elapsed, err_num);
+    EC_TRACE_SPAN("query", full_filename, total_start);
+    if (ec_slow_query_callback)
+        ec_metrics_slow_query(full_filename, config_files, stats, elapsed,
+                err_num);
 
     return err_num;
 }
 
+/*
+ * See the header file for the use of this function
+ */
+EDITORCONFIG_EXPORT
+int editorconfig_parse(const char* full_filename, editorconfig_handle h)
+{
+    return editorconfig_parse_internal(full_filename, h, 0);
+}
+
+/*
+ * See the header file for the use of this function
+ */
+EDITORCONFIG_EXPORT
+int editorconfig_try_parse(const char* full_filename, editorconfig_handle h,
+        editorconfig_load_callback loaded, void* user)
+{
+    struct editorconfig_handle*         eh = (struct editorconfig_handle*)h;
+    int                                 err_num;
+
+    err_num = editorconfig_parse_internal(full_filename, h, 1);
+
+    if (err_num == EDITORCONFIG_PARSE_WOULD_BLOCK)
+        ec_loader_enqueue(full_filename, eh->conf_file_name,
+                eh->ver.major, eh->ver.minor, eh->ver.patch, loaded, user);
+
+    return err_num;
+}
+
+/*
+ * See the header file for the use of this function
+ */
+EDITORCONFIG_EXPORT
+int editorconfig_parse_async(const char* full_filename,
+        const editorconfig_handle options, editorconfig_parse_callback done,
+        void* user)
+{
+    const struct editorconfig_handle*   eh =
+        (const struct editorconfig_handle*)options;
+    const char*                         conf_file_name = NULL;
+    struct editorconfig_version         ver;
+    struct editorconfig_version         cur_ver;
+
+    /* rather than crash later on the background queue */
+    if (!full_filename || !done)
+        return EDITORCONFIG_PARSE_INVALID_ARGUMENT;
+
+    SET_EDITORCONFIG_VERSION(&ver, 0, 0, 0);
+    if (eh) {
+        conf_file_name = eh->conf_file_name;
+        ver = eh->ver;
+    }
+
+    /* fail early on what editorconfig_parse() would refuse anyway */
+    editorconfig_get_version(&cur_ver.major, &cur_ver.minor,
+            &cur_ver.patch);
+    if (editorconfig_compare_version(&ver, &cur_ver) > 0)
+        return EDITORCONFIG_PARSE_VERSION_TOO_NEW;
+
+    if (!is_file_path_absolute(full_filename))
+        return EDITORCONFIG_PARSE_NOT_FULL_PATH;
+
+    ec_loader_parse(full_filename, conf_file_name,
+            ver.major, ver.minor, ver.patch, done, user);
+
+    return 0;
+}
+
 /*
  * See header file
  */
@@ -50,19 +50,16 @@ editorconfig_handle editorconfig_handle_init(void)
 EDITORCONFIG_EXPORT
 int editorconfig_handle_destroy(editorconfig_handle h)
 {
-    int                             i;
     struct editorconfig_handle*     eh = (struct editorconfig_handle*)h;
 
 
     if (h == NULL)
         return 0;
 
-    /* free name_values */
-    for (i = 0; i < eh->name_value_count; ++i) {
-        free(eh->name_values[i].name);
-        free(eh->name_values[i].value);
-    }
-    free(eh->name_values);
+    /* free the result */
+    free(eh->result);
+
+    editorconfig_handle_free_config_files(eh);
 
     /* free err_file */
     if (eh->err_file)
@@ -74,6 +71,38 @@ int editorconfig_handle_destroy(editorconfig_handle h)
     return 0;
 }
 
+/*
+ * Free a NULL-terminated array of strings
+ */
+static void free_strings(char** strings)
+{
+    char**          str;
+
+    if (strings == NULL)
+        return;
+
+    for (str = strings; *str != NULL; ++str)
+        free(*str);
+    free(strings);
+}
+
+/*
+ * See header file
+ */
+EDITORCONFIG_LOCAL
+void editorconfig_handle_free_config_files(struct editorconfig_handle* eh)
+{
+    free(eh->config_dir);
+    free(eh->config_conf_file_name);
+    free_strings(eh->config_files);
+    free_strings(eh->config_dir_patterns);
+
+    eh->config_dir = NULL;
+    eh->config_conf_file_name = NULL;
+    eh->config_files = NULL;
+    eh->config_dir_patterns = NULL;
+}
+
 /*
  * See header file
  */
@@ -138,14 +167,16 @@ EDITORCONFIG_EXPORT
 void editorconfig_handle_get_name_value(const editorconfig_handle h, int n,
         const char** name, const char** value)
 {
-    struct editorconfig_name_value* name_value = &((
-                const struct editorconfig_handle*)h)->name_values[n];
+    const struct editorconfig_handle*       eh =
+        (const struct editorconfig_handle*)h;
+    const struct editorconfig_result_entry* entry =
+        &((const struct editorconfig_result_entry*)eh->result)[n];
 
     if (name)
-        *name = name_value->name;
+        *name = eh->result + entry->name_offset;
 
     if (value)
-        *value = name_value->value;
+        *value = eh->result + entry->value_offset;
 }
 
 EDITORCONFIG_EXPORT
@@ -153,3 +184,56 @@ int editorconfig_handle_get_name_value_count(const editorconfig_handle h)
 {
     return ((const struct editorconfig_handle*)h)->name_value_count;
 }
+
+/*
+ * See header file
+ */
+EDITORCONFIG_EXPORT
+unsigned long long editorconfig_handle_get_fingerprint(
+        const editorconfig_handle h)
+{
+    const struct editorconfig_handle*       eh =
+        (const struct editorconfig_handle*)h;
+    /* FNV-1a. The result block has no pointers in it, so equal results are
+     * equal blocks */
+    uint64_t                                hash = 14695981039346656037ULL;
+    size_t                                  i;
+
+    for (i = 0; i < eh->result_size; ++i) {
+        hash ^= (unsigned char)eh->result[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * See header file
+ */
+EDITORCONFIG_EXPORT
+void editorconfig_handle_set_stats_enabled(editorconfig_handle h,
+        int enabled)
+{
+    struct editorconfig_handle*     eh = (struct editorconfig_handle*)h;
+
+    eh->stats_enabled = enabled != 0;
+    if (!eh->stats_enabled)
+        eh->has_stats = 0;
+}
+
+/*
+ * See header file
+ */
+EDITORCONFIG_EXPORT
+int editorconfig_handle_get_stats(const editorconfig_handle h,
+        editorconfig_query_stats* stats)
+{
+    const struct editorconfig_handle*   eh =
+        (const struct editorconfig_handle*)h;
+
+    if (!eh->has_stats)
+        return -1;
+
+    *stats = eh->stats;
+    return 0;
+}
@@ -30,6 +30,8 @@
 #include "global.h"
 #include <editorconfig/editorconfig_handle.h>
 
+#include <stdint.h>
+
 /*!
  * @brief A structure containing a name and its corresponding value.
  * @author EditorConfig Team
@@ -37,9 +39,9 @@
 struct editorconfig_name_value
 {
     /*! EditorConfig config item's name. */ 
-    char*       name;
+    const char* name;
     /*! EditorConfig config item's value. */ 
-    char*       value;
+    const char* value;
 };
 
 /*!
@@ -56,6 +58,18 @@ struct editorconfig_version
     int                     patch;
 };
 
+/*!
+ * @brief Where a name and its value are in the string table of a parsing
+ * result. Offsets are from the start of the result block.
+ */
+struct editorconfig_result_entry
+{
+    uint32_t    name_offset;
+    uint32_t    name_length;
+    uint32_t    value_offset;
+    uint32_t    value_length;
+};
+
 struct editorconfig_handle
 {
     /*!
@@ -76,14 +90,45 @@ struct editorconfig_handle
      */
     struct editorconfig_version         ver;
 
-    /*! Pointer to a list of editorconfig_name_value structures containing
-     * names and values of the parsed result */
-    struct editorconfig_name_value*     name_values;
+    /*! The parsed result as a single block: name_value_count
+     * editorconfig_result_entry structures, followed by the null-terminated
+     * names and values they refer to. There are no pointers in it, so the
+     * block can be copied as is. */
+    char*                               result;
 
-    /*! The total count of name_values structures pointed by name_values
-     * pointer */
+    /*! The size of the result block in bytes */
+    size_t                              result_size;
+
+    /*! The total count of names and values in the result block */
     int                                 name_value_count;
+
+    /*!
+     * The directory of the file parsed last, the conf file name used for it,
+     * and the editorconfig files that apply to files in that directory, from
+     * the top directory down. config_dir_patterns holds the directory of each
+     * editorconfig file, escaped for use in a glob pattern. These are reused
+     * when the next file parsed is in the same directory.
+     */
+    char*                               config_dir;
+    char*                               config_conf_file_name;
+    char**                              config_files;
+    char**                              config_dir_patterns;
+
+    /*! Set with editorconfig_handle_set_stats_enabled() */
+    int                                 stats_enabled;
+
+    /*! Set once stats holds the statistics of a parse */
+    int                                 has_stats;
+
+    /*! The statistics of the last parse, if stats_enabled */
+    editorconfig_query_stats            stats;
 };
 
+/*
+ * Free the editorconfig files kept in eh from the previous parse.
+ */
+EDITORCONFIG_LOCAL
+void editorconfig_handle_free_config_files(struct editorconfig_handle* eh);
+
 #endif /* !EDITORCONFIG_HANDLE_H__ */
 
@@ -33,6 +33,7 @@ http://code.google.com/p/inih/
 */
 
 #include <dispatch/dispatch.h>
+#include <list>
 #include <map>
 
 #include "global.h"
@@ -41,10 +42,13 @@ http://code.google.com/p/inih/
 #include <sys/stat.h>
 
 #include <ctype.h>
+#include <errno.h>
 #include <string.h>
 #include <unistd.h>
 
 #include "ini.h"
+#include "metrics.h"
+#include "probes.h"
 
 #define MAX_LINE 5000
 #define MAX_SECTION MAX_SECTION_NAME
@@ -118,6 +122,7 @@ int ini_parse_file(const char *file /* null terminated */,
     char* value;
     int lineno = 0;
     int error = 0;
+    uint64_t parse_start = EC_QUERY_CLOCK();
 
     const char  *p = file;
     
@@ -174,6 +179,7 @@ int ini_parse_file(const char *file /* null terminated */,
                     continue;
                 strncpy0(section, start + 1, sizeof(section));
                 *prev_name = '\0';
+                EC_QUERY_INC(sections);
             }
             else if (!error) {
                 /* No ']' found on section line */
@@ -217,25 +223,74 @@ int ini_parse_file(const char *file /* null terminated */,
         p = nextLine + 1;
     }
 
+    EC_QUERY_ADD(bytes_parsed, strlen(file));
+    EC_QUERY_ELAPSED(parse_ns, parse_start);
     return error;
 }
 
+struct CacheEntry;
+
+//  files that don't exist, least recently used first
+typedef std::list<struct CacheEntry*>   AbsentFileList;
+
 typedef struct CacheEntry
 {
     char                *filename = NULL;
     char                *data = NULL;
     dispatch_source_t   dispatchSource = NULL;
     int                 fd = 0;
+    size_t              bytes = 0;
+    uint64_t            hits = 0;
+    uint64_t            cachedAt = 0;   //  ec_coarse_now_ns()
+    uint64_t            lastUse = 0;
+    bool                dead = false;   //  out of the cache, waiting for its cancel handler
+    AbsentFileList::iterator    absentPos;  //  for a file that doesn't exist
     
     ~CacheEntry();
 } CacheEntry;
 
+/*  Marks a config file that does not exist. The entry watches the directory
+    instead of the file, so that creating the file invalidates it. */
+static char ini_absent_data[] = "";
+
+/*  The text of a config file is shared by its cache entry and the lookups
+    parsing it, whoever lets go of it last frees it. The reference count is
+    kept right before the text. */
+#define INI_TEXT_REFS(data)     (reinterpret_cast<long*>(data) - 1)
+
+static
+char* ini_text_alloc(size_t len)
+{
+    long    *refs = static_cast<long*>(malloc(sizeof(long) + len + 1 /* room for trailing NULL */));
+    
+    if (NULL == refs)
+        return NULL;
+    
+    *refs = 1;
+    return reinterpret_cast<char*>(refs + 1);
+}
+
+static
+void ini_text_retain(char *data)
+{
+    if (ini_absent_data != data)
+        __atomic_add_fetch(INI_TEXT_REFS(data), 1, __ATOMIC_RELAXED);
+}
+
+static
+void ini_text_release(char *data)
+{
+    if ((NULL != data) && (ini_absent_data != data) &&
+        (0 == __atomic_sub_fetch(INI_TEXT_REFS(data), 1, __ATOMIC_ACQ_REL)))
+        free(INI_TEXT_REFS(data));
+}
+
 CacheEntry::~CacheEntry()
 {
     free(filename);
-    free(data);
-    dispatch_source_cancel(dispatchSource);
-    dispatch_release(dispatchSource);
+    ini_text_release(data);
+    if (NULL != dispatchSource)
+        dispatch_release(dispatchSource);
 
     if (0 != fd)
         close(fd);
@@ -243,6 +298,10 @@ CacheEntry::~CacheEntry()
 
 typedef std::map<std::string, CacheEntry*>  FileDataCache;
 
+/*  Each file known not to exist holds a descriptor on its directory, so only
+    this many are kept; the least recently used goes first. */
+#define INI_CACHE_MAX_ABSENT    256
+
 ini_parse_cache_invalidation_callback   ini_parse_cache_invalidated;
 
 static
@@ -264,7 +323,7 @@ char* ini_data_from_file(const char *filename)
         return NULL;  //  errno is set
     }
     
-    data = static_cast<char*>(malloc(status.st_size + 1 /* room for trailing NULL */));
+    data = ini_text_alloc(status.st_size);
     if (NULL == data)
     {
         close(file);
@@ -275,24 +334,26 @@ char* ini_data_from_file(const char *filename)
     if (actLen < 0)
     {
         close(file);
-        free(data);
+        ini_text_release(data);
         
         return NULL;
     }
     
     data[actLen] = 0;   //  null terminate
+    EC_PROBE2(file__load, filename, actLen);
     
     close(file);
     return data;
 }
 
+static dispatch_once_t  _inited;
+static FileDataCache    *_map;
+static pthread_mutex_t  _mutex;
+static AbsentFileList   *_absent;
+
 static
-char* ini_data_for_file(const char *filename, const char *data /* NULL to fetch, otherwise to store */)
+void ini_cache_init(void)
 {
-    static dispatch_once_t  _inited;
-    static FileDataCache    *_map;
-    static pthread_mutex_t  _mutex;
-    
     dispatch_once(&_inited,
         ^()
         {
@@ -306,27 +367,110 @@ char* ini_data_for_file(const char *filename, const char *data /* NULL to fetch,
             pthread_mutexattr_destroy(&mutexAttrs);
 
             _map = new FileDataCache;
+            _absent = new AbsentFileList;
         }
     );
+}
+
+//  takes entry out of the cache and out of service; the lock must be held.
+//  Its event handler may be running, or waiting for the lock, so the cancel
+//  handler deletes it once the event handler can't run any more.
+static
+void ini_cache_remove(CacheEntry *entry)
+{
+    _map->erase(entry->filename);
+    if (ini_absent_data == entry->data)
+        _absent->erase(entry->absentPos);
+    entry->dead = true;
+    if (NULL != entry->dispatchSource)
+        dispatch_source_cancel(entry->dispatchSource);
+    else
+        delete entry;
+}
+
+//  makes room for one more file that doesn't exist; the lock must be held.
+static
+void ini_cache_evict_absent(void)
+{
+    if (_absent->size() < INI_CACHE_MAX_ABSENT)
+        return;
     
-    if (0 == pthread_mutex_lock(&_mutex))
+    EC_METRIC_INC(file_cache_evictions);
+    ini_cache_remove(_absent->front());
+}
+
+//  fetching retains the text, release it with ini_text_release(). Storing
+//  takes over the caller's reference.
+static
+char* ini_data_for_file(const char *filename, const char *data /* NULL to fetch, otherwise to store */)
+{
+    ini_cache_init();
+    
+    if (0 == EC_METRIC_LOCK(&_mutex, file_cache_lock))
     {
         if (NULL == data)
         {
-            CacheEntry  *entry = (*_map)[filename];
+            FileDataCache::iterator cached = _map->find(filename);
+            char        *found = NULL;
+            
+            if (_map->end() != cached)
+            {
+                CacheEntry  *entry = cached->second;
+                
+                if (ini_absent_data == entry->data)
+                    _absent->splice(_absent->end(), *_absent, entry->absentPos);
+                ++ entry->hits;
+                entry->lastUse = ec_coarse_now_ns();
+                found = entry->data;
+                ini_text_retain(found);
+            }
             
             pthread_mutex_unlock(&_mutex);
             
-            if (NULL != entry)
-                return entry->data;
+            return found;
         }
         else
         {
-            CacheEntry  *entry = new CacheEntry;
+            CacheEntry  *entry;
+            
+            //  another lookup may have read the file at the same time, and
+            //  cached it first. Its text may be being parsed, so keep it.
+            if (_map->end() != _map->find(filename))
+            {
+                ini_text_release(const_cast<char*>(data));
+                pthread_mutex_unlock(&_mutex);
+                return NULL;
+            }
             
+            entry = new CacheEntry;
             entry->filename = strdup(filename);
             entry->data = const_cast<char*>(data);
-            entry->fd = open(filename, O_EVTONLY);
+            entry->bytes = strlen(data);
+            entry->cachedAt = entry->lastUse = ec_coarse_now_ns();
+            if (data != ini_absent_data)
+                entry->fd = open(filename, O_EVTONLY);
+            else
+            {
+                //  watch the directory, it gets written when the file shows up
+                char    *dir = strdup(filename);
+                char    *slash = strrchr(dir, '/');
+                
+                if (NULL != slash)
+                    *slash = 0;
+                entry->fd = open((0 != *dir) ? dir : "/", O_EVTONLY);
+                free(dir);
+                
+                if (entry->fd < 0)
+                {
+                    //  don't cache what we can't watch
+                    entry->fd = 0;
+                    entry->data = NULL;
+                    delete entry;
+                    
+                    pthread_mutex_unlock(&_mutex);
+                    return NULL;
+                }
+            }
             entry->dispatchSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_VNODE,
                                                             entry->fd,
                                                             (DISPATCH_VNODE_DELETE | DISPATCH_VNODE_WRITE | DISPATCH_VNODE_EXTEND | DISPATCH_VNODE_RENAME | DISPATCH_VNODE_LINK | DISPATCH_VNODE_REVOKE),
@@ -336,33 +480,153 @@ char* ini_data_for_file(const char *filename, const char *data /* NULL to fetch,
                 ^()
                 {
                     //  we're here asynchronously on a different thread, so we need to acquire the lock.
-                    if (0 == pthread_mutex_lock(&_mutex))
+                    if (0 == EC_METRIC_LOCK(&_mutex, file_cache_lock))
                     {
-                        //  punch it out of the cache, we'll reread it the next time we need it
-                        (*_map)[entry->filename] = NULL;
-                        
-                        if (NULL != ini_parse_cache_invalidated)
-                            ini_parse_cache_invalidated(entry->filename);
+                        //  the cache may have let go of it while we waited
+                        if (! entry->dead)
+                        {
+                            //  punch it out of the cache, we'll reread it the next time we need it
+                            EC_METRIC_INC(file_cache_invalidations);
+                            
+                            if (NULL != ini_parse_cache_invalidated)
+                                ini_parse_cache_invalidated(entry->filename);
                             
-                        delete entry;   //  this does all the cleanup
+                            ini_cache_remove(entry);
+                        }
                         
                         pthread_mutex_unlock(&_mutex);
                     }
                 }
             );
+            dispatch_source_set_cancel_handler(entry->dispatchSource,
+                ^()
+                {
+                    delete entry;   //  this does all the cleanup
+                }
+            );
             
             //  cache it, then start the dispatch source
-
+            if (data == ini_absent_data)
+            {
+                ini_cache_evict_absent();
+                entry->absentPos = _absent->insert(_absent->end(), entry);
+            }
+            
             (*_map)[filename] = entry;
             dispatch_resume(entry->dispatchSource);
             
             pthread_mutex_unlock(&_mutex);
         }
     }
+    else if (NULL != data)
+        ini_text_release(const_cast<char*>(data));
     
     return NULL;
 }
 
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+size_t ini_cache_count(void)
+{
+    size_t  count = 0;
+    
+    ini_cache_init();
+    
+    if (0 == pthread_mutex_lock(&_mutex))
+    {
+        count = _map->size();
+        
+        pthread_mutex_unlock(&_mutex);
+    }
+    
+    return count;
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+void ini_cache_clear(void)
+{
+    ini_cache_init();
+    
+    if (0 == pthread_mutex_lock(&_mutex))
+    {
+        while (! _map->empty())
+        {
+            EC_METRIC_INC(file_cache_evictions);
+            ini_cache_remove(_map->begin()->second);
+        }
+        
+        pthread_mutex_unlock(&_mutex);
+    }
+}
+
+typedef struct ini_ruleset_size
+{
+    const char  *section;
+    uint64_t    sections;
+    uint64_t    properties;
+} ini_ruleset_size;
+
+static
+int ini_count_property(void* user, const char* section, const char* name,
+                       const char* value)
+{
+    ini_ruleset_size    *size = static_cast<ini_ruleset_size*>(user);
+    
+    //  the section buffer is reused, so compare what it holds
+    if ((NULL == size->section) || (0 != strcmp(size->section, section)))
+    {
+        free(const_cast<char*>(size->section));
+        size->section = strdup(section);
+        ++ size->sections;
+    }
+    ++ size->properties;
+    
+    return 1;
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+void ini_cache_dump(editorconfig_file_cache_visitor visit, void* user)
+{
+    ini_cache_init();
+    
+    if (0 == pthread_mutex_lock(&_mutex))
+    {
+        uint64_t    now = ec_coarse_now_ns();
+        
+        for (FileDataCache::const_iterator it = _map->begin(); it != _map->end(); ++it)
+        {
+            CacheEntry                      *cached = it->second;
+            editorconfig_file_cache_entry   entry;
+            ini_ruleset_size                size = { NULL, 0, 0 };
+            
+            //  the rules aren't kept, count them again from the text
+            if (ini_absent_data != cached->data)
+                ini_parse_file(cached->data, ini_count_property, &size);
+            free(const_cast<char*>(size.section));
+            
+            entry.path = cached->filename;
+            entry.exists = (ini_absent_data != cached->data);
+            if (! entry.exists)
+                entry.watch = EDITORCONFIG_CACHE_WATCH_DIRECTORY;
+            else if (cached->fd > 0)
+                entry.watch = EDITORCONFIG_CACHE_WATCH_FILE;
+            else
+                entry.watch = EDITORCONFIG_CACHE_WATCH_NONE;
+            entry.bytes = cached->bytes;
+            entry.sections = size.sections;
+            entry.properties = size.properties;
+            entry.hits = cached->hits;
+            entry.age_ns = now - cached->cachedAt;
+            entry.idle_ns = now - cached->lastUse;
+            visit(&entry, user);
+        }
+        
+        pthread_mutex_unlock(&_mutex);
+    }
+}
+
 /* See documentation in header file. */
 EDITORCONFIG_LOCAL
 int ini_parse(const char* filename,
@@ -371,25 +635,90 @@ int ini_parse(const char* filename,
 {
     char    *data = NULL;
     bool    wasCached = false;
+    uint64_t    load_start;
+    uint64_t    trace_start;
+    int         load_errno;
    
     data = ini_data_for_file(filename, NULL);
     if (NULL == data)
+    {
+        EC_METRIC_INC(file_cache_misses);
+        EC_PROBE1(file__cache__miss, filename);
+        EC_QUERY_INC(configs_from_disk);
+        load_start = EC_QUERY_CLOCK();
+        trace_start = EC_TRACE_CLOCK();
         data = ini_data_from_file(filename);
+        load_errno = errno;     //  before the probes below can change it
+        EC_QUERY_ELAPSED(load_ns, load_start);
+        EC_TRACE_SPAN("load", filename, trace_start);
+        
+        //  remember that there's nothing here, so that the next lookup
+        //  doesn't have to go to the disk either.
+        if ((NULL == data) && ((ENOENT == load_errno) || (ENOTDIR == load_errno)))
+            ini_data_for_file(filename, ini_absent_data);
+    }
     else
-        wasCached = true;
+    {
+        EC_METRIC_INC(file_cache_hits);
+        EC_PROBE1(file__cache__hit, filename);
+        EC_QUERY_INC(configs_from_cache);
+        
+        if (ini_absent_data == data)
+            return -1;
+        
+        wasCached = true;   //  and retained
+    }
     
     if (NULL != data)
     {
         int error = 0;
         
-        if (0 == (error = ini_parse_file(data, handler, user)))
-        {
-            if (! wasCached)
-                ini_data_for_file(filename, data);  //  cache it
-        }
+        EC_PROBE1(ini__parse__start, filename);
+        trace_start = EC_TRACE_CLOCK();
+        error = ini_parse_file(data, handler, user);
+        EC_TRACE_SPAN("parse", filename, trace_start);
+        EC_PROBE2(ini__parse__done, filename, error);
+        
+        //  cache it even with a syntax error, so that lookups from the
+        //  cache only report the same error
+        if (! wasCached)
+            ini_data_for_file(filename, data);
+        else
+            ini_text_release(data);
         
         return error;
     }
     
     return -1;
 }
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+int ini_parse_cached(const char* filename,
+                     int (*handler)(void*, const char*, const char*,
+                                    const char*),
+                     void* user)
+{
+    char    *data = ini_data_for_file(filename, NULL);
+    int     error;
+    uint64_t    trace_start;
+    
+    if (NULL == data)
+        return INI_PARSE_NOT_CACHED;
+    
+    EC_METRIC_INC(file_cache_hits);
+    EC_PROBE1(file__cache__hit, filename);
+    EC_QUERY_INC(configs_from_cache);
+    
+    if (ini_absent_data == data)
+        return -1;
+    
+    EC_PROBE1(ini__parse__start, filename);
+    trace_start = EC_TRACE_CLOCK();
+    error = ini_parse_file(data, handler, user);
+    EC_TRACE_SPAN("parse", filename, trace_start);
+    EC_PROBE2(ini__parse__done, filename, error);
+    ini_text_release(data);
+    
+    return error;
+}
@@ -37,6 +37,8 @@ http://code.google.com/p/inih/
 
 #include "global.h"
 
+#include <editorconfig/editorconfig.h>
+
 /* Make this header file easier to include in C++ code */
 #ifdef __cplusplus
 extern "C" {
@@ -60,6 +62,29 @@ int ini_parse(const char* filename,
                              const char* name, const char* value),
               void* user);
 
+/* Same as ini_parse(), but never touches the disk: the file is parsed only
+   if its contents are already in the cache. Returns INI_PARSE_NOT_CACHED if
+   they are not, and -1 if the file is known not to exist. */
+EDITORCONFIG_LOCAL
+int ini_parse_cached(const char* filename,
+                     int (*handler)(void* user, const char* section,
+                                    const char* name, const char* value),
+                     void* user);
+
+#define INI_PARSE_NOT_CACHED (-2)
+
+/* The count of files in the cache, including those known not to exist. */
+EDITORCONFIG_LOCAL
+size_t ini_cache_count(void);
+
+/* Forget all cached files. No ini_parse() call may be running. */
+EDITORCONFIG_LOCAL
+void ini_cache_clear(void);
+
+/* Call visit for each cached file, with the lock of the cache held. */
+EDITORCONFIG_LOCAL
+void ini_cache_dump(editorconfig_file_cache_visitor visit, void* user);
+
 /* Same as ini_parse(), but takes a FILE* instead of filename. This doesn't
    close the file when it's finished -- the caller must do that. */
 EDITORCONFIG_LOCAL
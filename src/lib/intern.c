@@ -0,0 +1,356 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "global.h"
+#include "intern.h"
+#include "ini.h"
+
+#include <ctype.h>
+#include <dispatch/dispatch.h>
+#include <pthread.h>
+
+const char* const ec_known_names[EC_NAME_COUNT] = {
+    "indent_style",
+    "indent_size",
+    "tab_width",
+    "end_of_line",
+    "charset",
+    "trim_trailing_whitespace",
+    "insert_final_newline",
+    "max_line_length",
+    "root"
+};
+
+const char* const ec_known_values[EC_VALUE_COUNT] = {
+    "tab",
+    "space",
+    "lf",
+    "crlf",
+    "cr",
+    "latin1",
+    "utf-8",
+    "utf-8-bom",
+    "utf-16be",
+    "utf-16le",
+    "true",
+    "false",
+    "unset",
+    "off"
+};
+
+typedef struct
+{
+    const char*     str;
+    size_t          len;
+    unsigned int    hash;
+    /* the lookups holding str, not counted for the known strings */
+    long            refs;
+    int             known;
+} intern_slot;
+
+/*
+ * Open addressing, the capacity is a power of 2 and kept at most half full.
+ * A string no lookup holds any more is only dropped when the table would
+ * otherwise have to grow, or when the caches are cleared, so that the strings
+ * of the editorconfig files in use stay in the table between lookups.
+ */
+static intern_slot*         _slots;
+static size_t               _capacity;
+static size_t               _count;
+static pthread_rwlock_t     _lock;
+
+static unsigned int intern_hash(const char* str, size_t len)
+{
+    /* FNV-1a */
+    unsigned int    hash = 2166136261u;
+    size_t          i;
+
+    for (i = 0; i < len; ++i) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/* Find the slot for str, which is either the one holding it or empty. */
+static intern_slot* intern_find(intern_slot* slots, size_t capacity,
+        const char* str, size_t len, unsigned int hash)
+{
+    size_t          i = hash & (capacity - 1);
+
+    while (slots[i].str != NULL) {
+        if (slots[i].hash == hash && slots[i].len == len &&
+                !memcmp(slots[i].str, str, len))
+            break;
+        i = (i + 1) & (capacity - 1);
+    }
+
+    return &slots[i];
+}
+
+static int intern_is_unused(const intern_slot* slot)
+{
+    return slot->str != NULL && !slot->known &&
+        __atomic_load_n(&slot->refs, __ATOMIC_RELAXED) == 0;
+}
+
+/*
+ * Move the strings to a table of new_capacity slots, dropping those no
+ * lookup holds if drop_unused is set. Caller holds the write lock.
+ */
+static int intern_rebuild(size_t new_capacity, int drop_unused)
+{
+    intern_slot*    new_slots;
+    size_t          i;
+
+    new_slots = (intern_slot*)calloc(new_capacity, sizeof(intern_slot));
+    if (new_slots == NULL)
+        return -1;
+
+    _count = 0;
+    for (i = 0; i < _capacity; ++i) {
+        if (drop_unused && intern_is_unused(&_slots[i]))
+            free((char*)_slots[i].str);
+        else if (_slots[i].str != NULL) {
+            *intern_find(new_slots, new_capacity, _slots[i].str, _slots[i].len,
+                    _slots[i].hash) = _slots[i];
+            ++ _count;
+        }
+    }
+
+    free(_slots);
+    _slots = new_slots;
+    _capacity = new_capacity;
+
+    return 0;
+}
+
+/*
+ * Make room for one more string, by dropping the unused ones if there are
+ * enough of them to be worth it, or else by growing the table. Caller holds
+ * the write lock.
+ */
+static int intern_make_room(void)
+{
+    size_t          unused = 0;
+    size_t          i;
+
+    if ((_count + 1) * 2 <= _capacity)
+        return 0;
+    if (_capacity == 0)
+        return intern_rebuild(256, 0);
+
+    for (i = 0; i < _capacity; ++i)
+        if (intern_is_unused(&_slots[i]))
+            ++ unused;
+
+    if (unused * 4 >= _count)
+        return intern_rebuild(_capacity, 1);
+
+    return intern_rebuild(_capacity * 2, 0);
+}
+
+/*
+ * Add str, which must not be in the table yet, held once unless it is one of
+ * the known strings. Caller holds the write lock. Returns the new slot, or
+ * NULL if out of memory.
+ */
+static intern_slot* intern_insert(const char* str, size_t len,
+        unsigned int hash, int known)
+{
+    intern_slot*    slot;
+
+    if (intern_make_room() != 0)
+        return NULL;
+
+    slot = intern_find(_slots, _capacity, str, len, hash);
+    slot->str = str;
+    slot->len = len;
+    slot->hash = hash;
+    slot->refs = known ? 0 : 1;
+    slot->known = known;
+    ++ _count;
+
+    return slot;
+}
+
+/*
+ * Hold the string in slot once more. Caller holds the lock, for reading is
+ * enough.
+ */
+static void intern_retain(intern_slot* slot)
+{
+    if (!slot->known)
+        __atomic_add_fetch(&slot->refs, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Find str in the table and hold it, or add a copy of it. Caller holds the
+ * write lock. Returns NULL if out of memory.
+ */
+static intern_slot* intern_find_or_insert(const char* str, size_t len,
+        unsigned int hash)
+{
+    intern_slot*    slot = NULL;
+    char*           copy;
+
+    if (_capacity != 0) {
+        slot = intern_find(_slots, _capacity, str, len, hash);
+        if (slot->str != NULL) {
+            intern_retain(slot);
+            return slot;
+        }
+    }
+
+    copy = (char*)malloc(len + 1);
+    if (copy == NULL)
+        return NULL;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    slot = intern_insert(copy, len, hash, 0);
+    if (slot == NULL)
+        free(copy);
+
+    return slot;
+}
+
+static void intern_init(void* context)
+{
+    int         i;
+
+    (void)context;
+
+    pthread_rwlock_init(&_lock, NULL);
+
+    /* the known strings are their own copies */
+    for (i = 0; i < EC_NAME_COUNT; ++i)
+        intern_insert(ec_known_names[i], strlen(ec_known_names[i]),
+                intern_hash(ec_known_names[i], strlen(ec_known_names[i])), 1);
+    for (i = 0; i < EC_VALUE_COUNT; ++i)
+        intern_insert(ec_known_values[i], strlen(ec_known_values[i]),
+                intern_hash(ec_known_values[i], strlen(ec_known_values[i])), 1);
+}
+
+static void intern_once(void)
+{
+    static dispatch_once_t  _inited;
+
+    dispatch_once_f(&_inited, NULL, intern_init);
+}
+
+EDITORCONFIG_LOCAL
+const char* ec_intern(const char* str, size_t len)
+{
+    unsigned int            hash = intern_hash(str, len);
+    const char*             found = NULL;
+    intern_slot*            slot;
+
+    intern_once();
+
+    /* nearly always there already, so try with the shared lock first */
+    if (pthread_rwlock_rdlock(&_lock) != 0)
+        return NULL;
+    if (_capacity != 0) {
+        slot = intern_find(_slots, _capacity, str, len, hash);
+        if (slot->str != NULL) {
+            intern_retain(slot);
+            found = slot->str;
+        }
+    }
+    pthread_rwlock_unlock(&_lock);
+
+    if (found != NULL)
+        return found;
+
+    if (pthread_rwlock_wrlock(&_lock) != 0)
+        return NULL;
+
+    /* someone else may have added it in the meantime */
+    slot = intern_find_or_insert(str, len, hash);
+    if (slot != NULL)
+        found = slot->str;
+
+    pthread_rwlock_unlock(&_lock);
+
+    return found;
+}
+
+EDITORCONFIG_LOCAL
+const char* ec_intern_lower(const char* str, size_t len)
+{
+    char                    buf[MAX_PROPERTY_VALUE + 1];
+    char*                   lwr = buf;
+    const char*             lower;
+    size_t                  i;
+
+    /* names and values fit in buf, unless they come from elsewhere */
+    if (len >= sizeof(buf)) {
+        lwr = (char*)malloc(len + 1);
+        if (lwr == NULL)
+            return NULL;
+    }
+    for (i = 0; i < len; ++i)
+        lwr[i] = (char)tolower((unsigned char)str[i]);
+
+    lower = ec_intern(lwr, len);
+    if (lwr != buf)
+        free(lwr);
+
+    return lower;
+}
+
+EDITORCONFIG_LOCAL
+void ec_intern_release(const char* str)
+{
+    size_t                  len;
+    intern_slot*            slot;
+
+    if (str == NULL)
+        return;
+
+    len = strlen(str);
+    intern_once();
+
+    if (pthread_rwlock_rdlock(&_lock) != 0)
+        return;
+    slot = intern_find(_slots, _capacity, str, len, intern_hash(str, len));
+    if (slot->str == str && !slot->known)
+        __atomic_sub_fetch(&slot->refs, 1, __ATOMIC_RELAXED);
+    pthread_rwlock_unlock(&_lock);
+}
+
+EDITORCONFIG_LOCAL
+void ec_intern_clear(void)
+{
+    intern_once();
+
+    if (pthread_rwlock_wrlock(&_lock) != 0)
+        return;
+    intern_rebuild(_capacity, 1);
+    pthread_rwlock_unlock(&_lock);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INTERN_H__
+#define INTERN_H__
+
+#include "global.h"
+
+/*
+ * Property names and values that EditorConfig knows about. ec_intern()
+ * returns exactly these pointers for them, so they can be compared by
+ * address. Only ever append to these lists, their order is used by the
+ * serialization format.
+ */
+enum
+{
+    EC_NAME_INDENT_STYLE,
+    EC_NAME_INDENT_SIZE,
+    EC_NAME_TAB_WIDTH,
+    EC_NAME_END_OF_LINE,
+    EC_NAME_CHARSET,
+    EC_NAME_TRIM_TRAILING_WHITESPACE,
+    EC_NAME_INSERT_FINAL_NEWLINE,
+    EC_NAME_MAX_LINE_LENGTH,
+    EC_NAME_ROOT,
+    EC_NAME_COUNT
+};
+
+enum
+{
+    EC_VALUE_TAB,
+    EC_VALUE_SPACE,
+    EC_VALUE_LF,
+    EC_VALUE_CRLF,
+    EC_VALUE_CR,
+    EC_VALUE_LATIN1,
+    EC_VALUE_UTF_8,
+    EC_VALUE_UTF_8_BOM,
+    EC_VALUE_UTF_16BE,
+    EC_VALUE_UTF_16LE,
+    EC_VALUE_TRUE,
+    EC_VALUE_FALSE,
+    EC_VALUE_UNSET,
+    EC_VALUE_OFF,
+    EC_VALUE_COUNT
+};
+
+extern const char* const ec_known_names[EC_NAME_COUNT];
+
+extern const char* const ec_known_values[EC_VALUE_COUNT];
+
+/*
+ * Return the one copy of the first len characters of str kept in the global
+ * table, adding it if needed. The result is null-terminated and held until it
+ * is passed to ec_intern_release(); the known names and values are never
+ * dropped. Returns NULL if out of memory.
+ */
+EDITORCONFIG_LOCAL
+const char* ec_intern(const char* str, size_t len);
+
+/*
+ * Same as ec_intern(), but return the interned lowercase version of str.
+ */
+EDITORCONFIG_LOCAL
+const char* ec_intern_lower(const char* str, size_t len);
+
+/*
+ * Let go of a string returned by ec_intern() or ec_intern_lower(). Does
+ * nothing if str is NULL.
+ */
+EDITORCONFIG_LOCAL
+void ec_intern_release(const char* str);
+
+/*
+ * Drop the strings that are not held. No lookup may be running.
+ */
+EDITORCONFIG_LOCAL
+void ec_intern_clear(void);
+
+#endif /* !INTERN_H__ */
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dispatch/dispatch.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "global.h"
+#include "loader.h"
+
+typedef struct LoaderRequest
+{
+    std::string                 path;
+    editorconfig_parse_callback done;
+    void                        *user;
+} LoaderRequest;
+
+typedef std::map<std::string, std::vector<LoaderRequest> >
+                                    LoaderRequests;
+
+static LoaderRequests               *_requests;
+static std::set<std::string>        *_conf_names;
+static pthread_mutex_t              _mutex;
+
+static
+void ec_loader_init(void)
+{
+    static dispatch_once_t  _inited;
+    
+    dispatch_once(&_inited,
+        ^()
+        {
+            pthread_mutex_init(&_mutex, NULL);
+            
+            _requests = new LoaderRequests;
+            _conf_names = new std::set<std::string>;
+        }
+    );
+}
+
+EDITORCONFIG_LOCAL
+void ec_loader_parse(const char* full_filename, const char* conf_file_name,
+        int major, int minor, int patch,
+        editorconfig_parse_callback done, void* user)
+{
+    const char      *slash = strrchr(full_filename, '/');
+    const char      *conf = NULL;
+    std::string     key;
+    char            ver_str[64];
+    LoaderRequest   request;
+    
+    ec_loader_init();
+    
+    request.path = full_filename;
+    request.done = done;
+    request.user = user;
+    
+    //  everything in a directory shares the config files, so requests
+    //  for the same directory are done by the same piece of work.
+    snprintf(ver_str, sizeof(ver_str), "%d.%d.%d", major, minor, patch);
+    key = std::string((NULL != conf_file_name) ? conf_file_name : ".editorconfig");
+    key += '\0';
+    key += ver_str;
+    key += '\0';
+    key.append(full_filename, (NULL != slash) ? slash - full_filename : 0);
+    
+    if (0 != pthread_mutex_lock(&_mutex))
+    {
+        done(full_filename, EDITORCONFIG_PARSE_MEMORY_ERROR, NULL, user);
+        return;
+    }
+    
+    //  the results outlive the caller's string, so keep our own copy
+    if (NULL != conf_file_name)
+        conf = _conf_names->insert(conf_file_name).first->c_str();
+    
+    LoaderRequests::iterator    it = _requests->find(key);
+    
+    if (it != _requests->end())
+    {
+        //  already on its way, just join it
+        it->second.push_back(request);
+        pthread_mutex_unlock(&_mutex);
+        
+        return;
+    }
+    
+    (*_requests)[key].push_back(request);
+    pthread_mutex_unlock(&_mutex);
+    
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+        ^()
+        {
+            for (;;)
+            {
+                std::vector<LoaderRequest>  batch;
+                
+                //  take whatever has been queued up so far, requests coming
+                //  in while we're busy get picked up by the next round.
+                if (0 != pthread_mutex_lock(&_mutex))
+                    break;
+                
+                batch.swap((*_requests)[key]);
+                if (batch.empty())
+                    _requests->erase(key);
+                
+                pthread_mutex_unlock(&_mutex);
+                
+                if (batch.empty())
+                    break;
+                
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    editorconfig_handle     eh = editorconfig_handle_init();
+                    int                     err_num = EDITORCONFIG_PARSE_MEMORY_ERROR;
+                    
+                    if (NULL != eh)
+                    {
+                        editorconfig_handle_set_conf_file_name(eh, conf);
+                        editorconfig_handle_set_version(eh, major, minor, patch);
+                        
+                        err_num = editorconfig_parse(batch[i].path.c_str(), eh);
+                    }
+                    
+                    //  the handle belongs to the callback now
+                    batch[i].done(batch[i].path.c_str(), err_num, eh, batch[i].user);
+                }
+            }
+        }
+    );
+}
+
+typedef struct LoaderWaiter
+{
+    editorconfig_load_callback  loaded;
+    void                        *user;
+} LoaderWaiter;
+
+static
+void ec_loader_loaded(const char* full_filename, int err_num,
+        editorconfig_handle result, void* user)
+{
+    LoaderWaiter    *waiter = static_cast<LoaderWaiter*>(user);
+    
+    editorconfig_handle_destroy(result);
+    
+    if (NULL != waiter->loaded)
+        waiter->loaded(full_filename, err_num, waiter->user);
+    
+    delete waiter;
+}
+
+EDITORCONFIG_LOCAL
+void ec_loader_enqueue(const char* full_filename, const char* conf_file_name,
+        int major, int minor, int patch,
+        editorconfig_load_callback loaded, void* user)
+{
+    LoaderWaiter    *waiter = new LoaderWaiter;
+    
+    waiter->loaded = loaded;
+    waiter->user = user;
+    
+    //  only the side effect on the caches is needed
+    ec_loader_parse(full_filename, conf_file_name, major, minor, patch,
+            ec_loader_loaded, waiter);
+}
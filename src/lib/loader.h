@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LOADER_H__
+#define LOADER_H__
+
+#include "global.h"
+#include <editorconfig/editorconfig.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Run editorconfig_parse() for full_filename on a background queue with a new
+ * handle, and pass that to done. Requests for files in the same directory
+ * with the same conf file name and version that come in while one is being
+ * worked on are done by the same piece of work.
+ */
+EDITORCONFIG_LOCAL
+void ec_loader_parse(const char* full_filename, const char* conf_file_name,
+        int major, int minor, int patch,
+        editorconfig_parse_callback done, void* user);
+
+/*
+ * Same as ec_loader_parse(), but only for warming the caches: the result is
+ * thrown away and loaded (if not NULL) is called instead.
+ */
+EDITORCONFIG_LOCAL
+void ec_loader_enqueue(const char* full_filename, const char* conf_file_name,
+        int major, int minor, int patch,
+        editorconfig_load_callback loaded, void* user);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !LOADER_H__ */
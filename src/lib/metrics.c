@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "global.h"
+#include "editorconfig.h"
+#include "ec_glob.h"
+#include "ini.h"
+#include "intern.h"
+#include "metrics.h"
+#include "probes.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+EDITORCONFIG_LOCAL
+ec_metrics ec_metrics_counters;
+
+EDITORCONFIG_LOCAL
+__thread editorconfig_query_stats* ec_query_stats;
+
+EDITORCONFIG_LOCAL
+int ec_metrics_phase_timing;
+
+EDITORCONFIG_LOCAL
+editorconfig_slow_query_callback ec_slow_query_callback;
+
+static void*            slow_query_user;
+static uint64_t         slow_query_threshold_ns;
+
+EDITORCONFIG_LOCAL
+editorconfig_trace_callback ec_trace_callback;
+
+static void*            trace_user;
+
+static const uint64_t   histogram_bounds[EC_HISTOGRAM_BUCKETS - 1] =
+    EC_HISTOGRAM_BOUNDS;
+
+static const char*      phase_names[EC_PHASE_COUNT] =
+{
+    "total", "discover", "load", "parse", "glob_compile", "glob_match",
+    "merge"
+};
+
+static const char*      error_names[EC_ERROR_SLOTS] =
+{
+    "syntax", "-1", "-2", "-3", "-4", "-5", "-6", "other"
+};
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+uint64_t ec_now_ns(void)
+{
+    struct timespec     ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+uint64_t ec_coarse_now_ns(void)
+{
+#ifdef CLOCK_MONOTONIC_COARSE
+    struct timespec     ts;
+
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#else
+    return ec_now_ns();
+#endif
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+int ec_metrics_lock(pthread_mutex_t* mutex, ec_lock_stats* stats)
+{
+    int         err = pthread_mutex_trylock(mutex);
+    uint64_t    start;
+
+    if (err == EBUSY) {
+        start = ec_now_ns();
+        err = pthread_mutex_lock(mutex);
+        __atomic_fetch_add(&stats->wait_ns, ec_now_ns() - start,
+                __ATOMIC_RELAXED);
+        __atomic_fetch_add(&stats->contended, 1, __ATOMIC_RELAXED);
+    }
+    if (err == 0)
+        __atomic_fetch_add(&stats->acquisitions, 1, __ATOMIC_RELAXED);
+
+    return err;
+}
+
+static void observe(int phase, uint64_t ns)
+{
+    ec_histogram*   h = &ec_metrics_counters.phases[phase];
+    int             i = 0;
+
+    while (i < EC_HISTOGRAM_BUCKETS - 1 && ns > histogram_bounds[i])
+        ++ i;
+    __atomic_fetch_add(&h->buckets[i], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum_ns, ns, __ATOMIC_RELAXED);
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+void ec_metrics_query_done(const editorconfig_query_stats* stats,
+        uint64_t total_ns, int err_num)
+{
+    EC_METRIC_INC(queries);
+    if (err_num > 0)
+        EC_METRIC_INC(errors[0]);
+    else if (err_num < 0)
+        EC_METRIC_INC(errors[-err_num < EC_ERROR_SLOTS - 1 ?
+                -err_num : EC_ERROR_SLOTS - 1]);
+
+    observe(EC_PHASE_TOTAL, total_ns);
+    if (stats == NULL)
+        return;
+
+    /* a phase that did not happen is not observed */
+    if (stats->discover_ns)
+        observe(EC_PHASE_DISCOVER, stats->discover_ns);
+    if (stats->load_ns)
+        observe(EC_PHASE_LOAD, stats->load_ns);
+    if (stats->parse_ns)
+        observe(EC_PHASE_PARSE, stats->parse_ns);
+    if (stats->glob_compile_ns)
+        observe(EC_PHASE_GLOB_COMPILE, stats->glob_compile_ns);
+    if (stats->glob_match_ns)
+        observe(EC_PHASE_GLOB_MATCH, stats->glob_match_ns);
+    if (stats->merge_ns)
+        observe(EC_PHASE_MERGE, stats->merge_ns);
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_EXPORT
+void editorconfig_metrics_set_phase_timing(int enabled)
+{
+    __atomic_store_n(&ec_metrics_phase_timing, enabled != 0,
+            __ATOMIC_RELAXED);
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+void ec_metrics_slow_query(const char* full_filename,
+        const char* const* config_files,
+        const editorconfig_query_stats* stats, uint64_t total_ns,
+        int err_num)
+{
+    editorconfig_slow_query     query;
+
+    if (total_ns < slow_query_threshold_ns)
+        return;
+
+    query.full_filename = full_filename;
+    query.config_files = config_files;
+    query.err_num = err_num;
+    if (stats)
+        query.stats = *stats;
+    else
+        memset(&query.stats, 0, sizeof(query.stats));
+    query.stats.total_ns = total_ns;
+    ec_slow_query_callback(&query, slow_query_user);
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_EXPORT
+void editorconfig_set_slow_query_callback(unsigned long long threshold_ns,
+        editorconfig_slow_query_callback slow, void* user)
+{
+    slow_query_threshold_ns = threshold_ns;
+    slow_query_user = user;
+    ec_slow_query_callback = slow;
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+void ec_trace_span(const char* name, const char* subject, uint64_t start_ns)
+{
+    editorconfig_trace_span     span;
+
+    span.name = name;
+    span.subject = subject;
+    span.start_ns = start_ns;
+    span.duration_ns = ec_now_ns() - start_ns;
+    ec_trace_callback(&span, trace_user);
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_EXPORT
+void editorconfig_set_trace_callback(editorconfig_trace_callback trace,
+        void* user)
+{
+    trace_user = user;
+    ec_trace_callback = trace;
+}
+
+/* where editorconfig_metrics_snapshot() writes, and how much it needs */
+typedef struct
+{
+    char*       buf;
+    size_t      len;
+    size_t      used;
+} snapshot_writer;
+
+static void append(snapshot_writer* w, const char* format, ...)
+{
+    va_list     args;
+    int         n;
+
+    va_start(args, format);
+    n = vsnprintf(w->used < w->len ? w->buf + w->used : NULL,
+            w->used < w->len ? w->len - w->used : 0, format, args);
+    va_end(args);
+    if (n > 0)
+        w->used += (size_t)n;
+}
+
+static void append_header(snapshot_writer* w, const char* name,
+        const char* type, const char* help)
+{
+    append(w, "# HELP editorconfig_%s %s\n# TYPE editorconfig_%s %s\n",
+            name, help, name, type);
+}
+
+/* one line per cache of a metric labeled by cache */
+static void append_per_cache(snapshot_writer* w, const char* name,
+        const char* type, const char* help,
+        unsigned long long file_value, unsigned long long glob_value)
+{
+    append_header(w, name, type, help);
+    append(w, "editorconfig_%s{cache=\"file\"} %llu\n", name, file_value);
+    append(w, "editorconfig_%s{cache=\"glob\"} %llu\n", name, glob_value);
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_EXPORT
+size_t editorconfig_metrics_snapshot(char* buf, size_t len)
+{
+    snapshot_writer             w;
+    editorconfig_cache_stats    cs;
+    int                         i;
+    int                         j;
+
+    w.buf = buf;
+    w.len = len;
+    w.used = 0;
+    if (len > 0)
+        buf[0] = '\0';
+
+    editorconfig_get_cache_stats(&cs);
+
+    append_header(&w, "queries_total", "counter",
+            "Lookups of the properties of a file.");
+    append(&w, "editorconfig_queries_total %llu\n",
+            (unsigned long long)EC_METRIC_GET(queries));
+
+    append_header(&w, "errors_total", "counter",
+            "Lookups that failed, by error code, \"syntax\" being a syntax "
+            "error in a config file.");
+    for (i = 0; i < EC_ERROR_SLOTS; ++i)
+        append(&w, "editorconfig_errors_total{code=\"%s\"} %llu\n",
+                error_names[i], (unsigned long long)EC_METRIC_GET(errors[i]));
+
+    append_header(&w, "phase_duration_seconds", "histogram",
+            "Time spent per lookup in each phase. Phases other than total "
+            "are only timed with phase timing on, or for handles that "
+            "record statistics.");
+    for (i = 0; i < EC_PHASE_COUNT; ++i) {
+        unsigned long long  count = 0;
+
+        for (j = 0; j < EC_HISTOGRAM_BUCKETS; ++j) {
+            count += EC_METRIC_GET(phases[i].buckets[j]);
+            if (j < EC_HISTOGRAM_BUCKETS - 1)
+                append(&w, "editorconfig_phase_duration_seconds_bucket"
+                        "{phase=\"%s\",le=\"%g\"} %llu\n", phase_names[i],
+                        histogram_bounds[j] / 1e9, count);
+            else
+                append(&w, "editorconfig_phase_duration_seconds_bucket"
+                        "{phase=\"%s\",le=\"+Inf\"} %llu\n", phase_names[i],
+                        count);
+        }
+        append(&w, "editorconfig_phase_duration_seconds_sum{phase=\"%s\"} "
+                "%.9f\n", phase_names[i],
+                EC_METRIC_GET(phases[i].sum_ns) / 1e9);
+        append(&w, "editorconfig_phase_duration_seconds_count{phase=\"%s\"} "
+                "%llu\n", phase_names[i], count);
+    }
+
+    append_per_cache(&w, "cache_entries", "gauge", "Entries in the cache.",
+            cs.file_entries, cs.glob_entries);
+    append_per_cache(&w, "cache_hits_total", "counter",
+            "Lookups in the cache that found an entry.",
+            cs.file_hits, cs.glob_hits);
+    append_per_cache(&w, "cache_misses_total", "counter",
+            "Lookups in the cache that found no entry.",
+            cs.file_misses, cs.glob_misses);
+    append_per_cache(&w, "cache_evictions_total", "counter",
+            "Entries dropped by editorconfig_clear_caches() or to bound "
+            "the cache.",
+            (unsigned long long)EC_METRIC_GET(file_cache_evictions),
+            (unsigned long long)EC_METRIC_GET(glob_cache_evictions));
+
+    append_header(&w, "cache_invalidations_total", "counter",
+            "Entries dropped because their config file changed.");
+    append(&w, "editorconfig_cache_invalidations_total{cache=\"file\"} "
+            "%llu\n",
+            (unsigned long long)EC_METRIC_GET(file_cache_invalidations));
+
+    append_per_cache(&w, "cache_lock_acquisitions_total", "counter",
+            "Times the lock of the cache was taken by a lookup.",
+            cs.file_lock_acquisitions, cs.glob_lock_acquisitions);
+    append_per_cache(&w, "cache_lock_contended_total", "counter",
+            "Times taking the lock of the cache had to wait.",
+            cs.file_lock_contended, cs.glob_lock_contended);
+    append_header(&w, "cache_lock_wait_seconds_total", "counter",
+            "Time spent waiting for the lock of the cache.");
+    append(&w, "editorconfig_cache_lock_wait_seconds_total{cache=\"file\"} "
+            "%.9f\n", cs.file_lock_wait_ns / 1e9);
+    append(&w, "editorconfig_cache_lock_wait_seconds_total{cache=\"glob\"} "
+            "%.9f\n", cs.glob_lock_wait_ns / 1e9);
+
+    return w.used;
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_EXPORT
+void editorconfig_get_cache_stats(editorconfig_cache_stats* stats)
+{
+    stats->file_hits = EC_METRIC_GET(file_cache_hits);
+    stats->file_misses = EC_METRIC_GET(file_cache_misses);
+    stats->file_entries = ini_cache_count();
+    stats->glob_hits = EC_METRIC_GET(glob_cache_hits);
+    stats->glob_misses = EC_METRIC_GET(glob_cache_misses);
+    stats->glob_entries = ec_glob_cache_count();
+    stats->file_lock_acquisitions =
+        EC_METRIC_GET(file_cache_lock.acquisitions);
+    stats->file_lock_contended = EC_METRIC_GET(file_cache_lock.contended);
+    stats->file_lock_wait_ns = EC_METRIC_GET(file_cache_lock.wait_ns);
+    stats->glob_lock_acquisitions =
+        EC_METRIC_GET(glob_cache_lock.acquisitions);
+    stats->glob_lock_contended = EC_METRIC_GET(glob_cache_lock.contended);
+    stats->glob_lock_wait_ns = EC_METRIC_GET(glob_cache_lock.wait_ns);
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_EXPORT
+void editorconfig_clear_caches(void)
+{
+    ini_cache_clear();
+    ec_glob_cache_clear();
+    ec_intern_clear();
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_EXPORT
+void editorconfig_dump_caches(editorconfig_glob_cache_visitor glob,
+        editorconfig_file_cache_visitor file, void* user)
+{
+    if (glob)
+        ec_glob_cache_dump(glob, user);
+    if (file)
+        ini_cache_dump(file, user);
+}
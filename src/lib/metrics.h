@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef METRICS_H__
+#define METRICS_H__
+
+#include "global.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <editorconfig/editorconfig.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Process-wide counters of the library's caches. They are updated with
+ * relaxed atomics from whichever thread does the lookup, so a snapshot is
+ * only loosely consistent across fields.
+ */
+typedef struct ec_lock_stats
+{
+    uint64_t    acquisitions;
+    /* acquisitions that had to wait for another thread */
+    uint64_t    contended;
+    /* the time spent waiting, in nanoseconds */
+    uint64_t    wait_ns;
+} ec_lock_stats;
+
+/* Upper bounds of the latency histogram buckets, in nanoseconds. The last
+ * bucket takes everything above them. */
+#define EC_HISTOGRAM_BOUNDS \
+    { 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, \
+      1000000, 2500000, 5000000, 10000000, 25000000, 50000000, 100000000 }
+#define EC_HISTOGRAM_BUCKETS    17
+
+typedef struct ec_histogram
+{
+    /* not cumulative, bucket i counts what fell between bounds i-1 and i */
+    uint64_t    buckets[EC_HISTOGRAM_BUCKETS];
+    uint64_t    sum_ns;
+} ec_histogram;
+
+/* the phases of a lookup, as in editorconfig_query_stats */
+enum
+{
+    EC_PHASE_TOTAL,
+    EC_PHASE_DISCOVER,
+    EC_PHASE_LOAD,
+    EC_PHASE_PARSE,
+    EC_PHASE_GLOB_COMPILE,
+    EC_PHASE_GLOB_MATCH,
+    EC_PHASE_MERGE,
+    EC_PHASE_COUNT
+};
+
+/* errors returned by editorconfig_parse(): syntax errors, which are line
+ * numbers, then the error codes from -1 down */
+#define EC_ERROR_SLOTS          8
+
+typedef struct ec_metrics
+{
+    uint64_t        queries;
+    uint64_t        errors[EC_ERROR_SLOTS];
+    ec_histogram    phases[EC_PHASE_COUNT];
+    uint64_t        file_cache_hits;
+    uint64_t        file_cache_misses;
+    /* entries dropped because the file changed */
+    uint64_t        file_cache_invalidations;
+    /* entries dropped by editorconfig_clear_caches(), and the least recently
+     * used config files that don't exist once too many are cached */
+    uint64_t        file_cache_evictions;
+    uint64_t        glob_cache_hits;
+    uint64_t        glob_cache_misses;
+    uint64_t        glob_cache_evictions;
+    ec_lock_stats   file_cache_lock;
+    ec_lock_stats   glob_cache_lock;
+} ec_metrics;
+
+EDITORCONFIG_LOCAL
+extern ec_metrics ec_metrics_counters;
+
+#define EC_METRIC_ADD(counter, n) \
+    ((void)__atomic_fetch_add(&ec_metrics_counters.counter, (n), \
+                              __ATOMIC_RELAXED))
+#define EC_METRIC_INC(counter) EC_METRIC_ADD(counter, 1)
+#define EC_METRIC_GET(counter) \
+    __atomic_load_n(&ec_metrics_counters.counter, __ATOMIC_RELAXED)
+
+/*
+ * pthread_mutex_lock() that counts into stats. The lock is tried first, so
+ * that only contended acquisitions pay for reading the clock.
+ */
+EDITORCONFIG_LOCAL
+int ec_metrics_lock(pthread_mutex_t* mutex, ec_lock_stats* stats);
+
+#define EC_METRIC_LOCK(mutex, lock) \
+    ec_metrics_lock((mutex), &ec_metrics_counters.lock)
+
+/* CLOCK_MONOTONIC in nanoseconds */
+EDITORCONFIG_LOCAL
+uint64_t ec_now_ns(void);
+
+/* Same as ec_now_ns(), but cheaper and only as precise as the scheduler
+ * tick where the system has a coarse clock. Good enough for the ages of
+ * cache entries, which are stamped on every lookup. */
+EDITORCONFIG_LOCAL
+uint64_t ec_coarse_now_ns(void);
+
+/* Set with editorconfig_metrics_set_phase_timing() */
+EDITORCONFIG_LOCAL
+extern int ec_metrics_phase_timing;
+
+/*
+ * Account for a finished editorconfig_parse() call that took total_ns and
+ * returned err_num. stats holds its statistics, or is NULL if it did not
+ * record any, in which case only the total time goes into the histograms.
+ */
+EDITORCONFIG_LOCAL
+void ec_metrics_query_done(const editorconfig_query_stats* stats,
+        uint64_t total_ns, int err_num);
+
+/* Set with editorconfig_set_slow_query_callback() */
+EDITORCONFIG_LOCAL
+extern editorconfig_slow_query_callback ec_slow_query_callback;
+
+/*
+ * Pass the editorconfig_parse() call for full_filename to the slow query
+ * callback if it took at least the threshold. config_files and stats may be
+ * NULL, as for ec_metrics_query_done().
+ */
+EDITORCONFIG_LOCAL
+void ec_metrics_slow_query(const char* full_filename,
+        const char* const* config_files,
+        const editorconfig_query_stats* stats, uint64_t total_ns,
+        int err_num);
+
+/*
+ * The statistics of the editorconfig_parse() call running on this thread,
+ * or NULL if it does not record any. The EC_QUERY macros do nothing then,
+ * and do not evaluate their arguments.
+ */
+EDITORCONFIG_LOCAL
+extern __thread editorconfig_query_stats* ec_query_stats;
+
+#define EC_QUERY_ADD(field, n) \
+    do { \
+        if (ec_query_stats) \
+            ec_query_stats->field += (n); \
+    } while (0)
+#define EC_QUERY_INC(field) EC_QUERY_ADD(field, 1)
+
+/* The start of a timed phase, to be given to EC_QUERY_ELAPSED() at its end */
+#define EC_QUERY_CLOCK() (ec_query_stats ? ec_now_ns() : 0)
+#define EC_QUERY_ELAPSED(field, start) \
+    EC_QUERY_ADD(field, ec_now_ns() - (start))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !METRICS_H__ */
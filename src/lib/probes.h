@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * USDT probes on the resolution pipeline, for bpftrace, perf and other
+ * tools that attach to static tracepoints. They are compiled in only if
+ * the build was configured with ENABLE_USDT; otherwise the macros expand to
+ * nothing and their arguments are not evaluated.
+ *
+ * The provider is "editorconfig". Strings are passed as pointers, and
+ * probes ending in __start and __done bracket a span of work:
+ *
+ * query__start(path)                   editorconfig_parse() begins
+ * query__done(path, err_num)           and returns
+ * config__discover(config, index)      an ancestor config file is looked at
+ * file__cache__hit(config)             its contents, or its absence, were
+ * file__cache__miss(config)            cached or not
+ * file__load(config, bytes)            it was read from the disk
+ * ini__parse__start(config)            it is parsed
+ * ini__parse__done(config, err)
+ * glob__cache__hit(pattern)            a section glob was compiled already
+ * glob__cache__miss(pattern)           or not
+ * glob__compile__start(pattern)        it is compiled
+ * glob__compile__done(pattern, ok)
+ * glob__match__start(pattern, path)    it is matched against the path
+ * glob__match__done(pattern, path, result)
+ * merge__start(path)                   the values found are merged
+ * merge__done(path, count)
+ *
+ * The same spans of work, and the discovery and loading of the config files,
+ * are also passed as they end to the callback set with
+ * editorconfig_set_trace_callback(). That costs a test of the callback
+ * pointer when none is set.
+ */
+
+#ifndef PROBES_H__
+#define PROBES_H__
+
+#include "global.h"
+#include "metrics.h"
+
+#ifdef ENABLE_USDT
+
+#include <sys/sdt.h>
+
+#define EC_PROBE1(name, a)          DTRACE_PROBE1(editorconfig, name, a)
+#define EC_PROBE2(name, a, b)       DTRACE_PROBE2(editorconfig, name, a, b)
+#define EC_PROBE3(name, a, b, c)    DTRACE_PROBE3(editorconfig, name, a, b, c)
+
+#else /* ENABLE_USDT */
+
+#define EC_PROBE1(name, a)          do { } while (0)
+#define EC_PROBE2(name, a, b)       do { } while (0)
+#define EC_PROBE3(name, a, b, c)    do { } while (0)
+
+#endif /* ENABLE_USDT */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Set with editorconfig_set_trace_callback() */
+EDITORCONFIG_LOCAL
+extern editorconfig_trace_callback ec_trace_callback;
+
+/* Pass the span name of subject that began at start_ns and ends now to the
+ * trace callback. */
+EDITORCONFIG_LOCAL
+void ec_trace_span(const char* name, const char* subject, uint64_t start_ns);
+
+#ifdef __cplusplus
+}
+#endif
+
+/* The start of a span, 0 when not tracing */
+#define EC_TRACE_CLOCK() (ec_trace_callback ? ec_now_ns() : 0)
+#define EC_TRACE_SPAN(name, subject, start) do { \
+    if (ec_trace_callback) \
+        ec_trace_span((name), (subject), (start)); \
+} while (0)
+
+#endif /* !PROBES_H__ */
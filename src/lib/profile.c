@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <dispatch/dispatch.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "global.h"
+
+#include <editorconfig/editorconfig.h>
+
+#include "profile.h"
+
+typedef struct ec_profile_counts
+{
+    uint64_t    attempts = 0;
+    uint64_t    matches = 0;
+    uint64_t    matchNs = 0;
+    uint64_t    maxMatchNs = 0;
+} ec_profile_counts;
+
+//  keyed by config file, then section
+typedef std::map<std::pair<std::string, std::string>, ec_profile_counts>
+                                                    ec_profile_map;
+
+EDITORCONFIG_LOCAL
+int ec_profile_enabled;
+
+static dispatch_once_t  _inited;
+static ec_profile_map   *_map;
+static pthread_mutex_t  _mutex;
+
+static
+void ec_profile_init(void)
+{
+    dispatch_once(&_inited,
+        ^()
+        {
+            pthread_mutex_init(&_mutex, NULL);
+            _map = new ec_profile_map;
+        }
+    );
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_LOCAL
+void ec_profile_record(const char* config_file, const char* section,
+        int matched, uint64_t ns)
+{
+    ec_profile_init();
+    
+    if (0 == pthread_mutex_lock(&_mutex))
+    {
+        ec_profile_counts   &counts =
+            (*_map)[std::make_pair(std::string(config_file), std::string(section))];
+        
+        ++ counts.attempts;
+        if (matched)
+            ++ counts.matches;
+        counts.matchNs += ns;
+        counts.maxMatchNs = std::max(counts.maxMatchNs, ns);
+        
+        pthread_mutex_unlock(&_mutex);
+    }
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_EXPORT
+void editorconfig_profile_set_enabled(int enabled)
+{
+    __atomic_store_n(&ec_profile_enabled, enabled != 0, __ATOMIC_RELAXED);
+}
+
+static
+bool ec_profile_costlier(ec_profile_map::const_iterator a,
+        ec_profile_map::const_iterator b)
+{
+    return a->second.matchNs > b->second.matchNs;
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_EXPORT
+void editorconfig_profile_dump(editorconfig_profile_visitor visit, void* user)
+{
+    ec_profile_init();
+    
+    if (0 == pthread_mutex_lock(&_mutex))
+    {
+        std::vector<ec_profile_map::const_iterator>  sorted;
+        
+        for (ec_profile_map::const_iterator it = _map->begin(); it != _map->end(); ++it)
+            sorted.push_back(it);
+        std::stable_sort(sorted.begin(), sorted.end(), ec_profile_costlier);
+        
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+            editorconfig_profile_entry  entry;
+            
+            entry.config_file = sorted[i]->first.first.c_str();
+            entry.section = sorted[i]->first.second.c_str();
+            entry.attempts = sorted[i]->second.attempts;
+            entry.matches = sorted[i]->second.matches;
+            entry.match_ns = sorted[i]->second.matchNs;
+            entry.max_match_ns = sorted[i]->second.maxMatchNs;
+            visit(&entry, user);
+        }
+        
+        pthread_mutex_unlock(&_mutex);
+    }
+}
+
+/* See documentation in header file. */
+EDITORCONFIG_EXPORT
+void editorconfig_profile_reset(void)
+{
+    ec_profile_init();
+    
+    if (0 == pthread_mutex_lock(&_mutex))
+    {
+        _map->clear();
+        pthread_mutex_unlock(&_mutex);
+    }
+}
@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "global.h"
+#include "editorconfig.h"
+#include "intern.h"
+
+#include <limits.h>
+
+/*
+ * Serialized format, all numbers are unsigned LEB128 varints:
+ *
+ *   count, then count times: name token, value token
+ *
+ * With D the size of the dictionary, a name token t is
+ *   t < NAME_SLOTS                 ec_known_names[t]
+ *   t < NAME_SLOTS + D             dictionary[t - NAME_SLOTS]
+ *   otherwise                      t - NAME_SLOTS - D bytes follow
+ *
+ * and a value token t is
+ *   t < VALUE_SLOTS                ec_known_values[t]
+ *   t < VALUE_SLOTS + D            dictionary[t - VALUE_SLOTS]
+ *   otherwise, with n = t - VALUE_SLOTS - D,
+ *     n even                       the decimal integer n / 2
+ *     n odd                        (n - 1) / 2 bytes follow
+ *
+ * The slot counts are fixed so that adding known names or values later does
+ * not change the meaning of existing data.
+ */
+#define NAME_SLOTS          16
+#define VALUE_SLOTS         32
+
+/* only decimal integers of at most this many digits are encoded as numbers,
+ * so that n * 2 always fits in 64 bits */
+#define MAX_INTEGER_DIGITS  18
+
+/* the longest varint a 64-bit number can take */
+#define MAX_VARINT_LENGTH   10
+
+typedef char names_fit_in_slots[EC_NAME_COUNT <= NAME_SLOTS ? 1 : -1];
+typedef char values_fit_in_slots[EC_VALUE_COUNT <= VALUE_SLOTS ? 1 : -1];
+
+/*
+ * A decoded name or value. str is NULL if it is the integer num.
+ */
+typedef struct
+{
+    const char*     str;
+    size_t          len;
+    uint64_t        num;
+} serial_string;
+
+/*
+ * Write v at buf + pos if it fits in buf_size, and return the position after
+ * it either way.
+ */
+static size_t put_varint(unsigned char* buf, size_t buf_size, size_t pos,
+        uint64_t v)
+{
+    do {
+        unsigned char   byte = v & 0x7f;
+
+        v >>= 7;
+        if (v)
+            byte |= 0x80;
+        if (pos < buf_size)
+            buf[pos] = byte;
+        ++ pos;
+    } while (v);
+
+    return pos;
+}
+
+static size_t put_bytes(unsigned char* buf, size_t buf_size, size_t pos,
+        const char* bytes, size_t len)
+{
+    if (pos < buf_size)
+        memcpy(buf + pos, bytes, pos + len <= buf_size ? len : buf_size - pos);
+
+    return pos + len;
+}
+
+/*
+ * Read a varint at *p. Returns 0 if successful, -1 if it runs past end or
+ * does not fit in 64 bits.
+ */
+static int get_varint(const unsigned char** p, const unsigned char* end,
+        uint64_t* v)
+{
+    const unsigned char*    q = *p;
+    int                     shift = 0;
+
+    *v = 0;
+    while (q < end && shift < 7 * MAX_VARINT_LENGTH) {
+        unsigned char   byte = *q++;
+
+        if (shift == 63 && byte > 1)
+            return -1;
+
+        *v |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            *p = q;
+            return 0;
+        }
+        shift += 7;
+    }
+
+    return -1;
+}
+
+/*
+ * Index of the string of length len in list, or -1.
+ */
+static int find_string(const char* const* list, int count, const char* str,
+        size_t len)
+{
+    int             i;
+
+    for (i = 0; i < count; ++i)
+        if (!strncmp(list[i], str, len) && list[i][len] == '\0')
+            return i;
+
+    return -1;
+}
+
+/*
+ * Whether str is a decimal integer without leading zeros that is short
+ * enough to be encoded as a number. If so, it is stored in num.
+ */
+static int is_small_integer(const char* str, size_t len, uint64_t* num)
+{
+    size_t          i;
+
+    if (len == 0 || len > MAX_INTEGER_DIGITS || (str[0] == '0' && len > 1))
+        return 0;
+
+    *num = 0;
+    for (i = 0; i < len; ++i) {
+        if (str[i] < '0' || str[i] > '9')
+            return 0;
+        *num = *num * 10 + (uint64_t)(str[i] - '0');
+    }
+
+    return 1;
+}
+
+static size_t integer_length(uint64_t num)
+{
+    size_t          len = 1;
+
+    while (num >= 10) {
+        num /= 10;
+        ++ len;
+    }
+
+    return len;
+}
+
+/*
+ * Decode a name (if is_value is 0) or a value token at *p.
+ */
+static int get_string(const unsigned char** p, const unsigned char* end,
+        const char* const* dictionary, int dictionary_size, int is_value,
+        serial_string* s)
+{
+    uint64_t        t;
+    uint64_t        slots = is_value ? VALUE_SLOTS : NAME_SLOTS;
+    uint64_t        known = is_value ? EC_VALUE_COUNT : EC_NAME_COUNT;
+
+    if (get_varint(p, end, &t))
+        return -1;
+
+    s->str = NULL;
+    if (t < slots) {
+        if (t >= known)
+            return -1;
+        s->str = is_value ? ec_known_values[t] : ec_known_names[t];
+        s->len = strlen(s->str);
+        return 0;
+    }
+
+    t -= slots;
+    if (t < (uint64_t)dictionary_size) {
+        s->str = dictionary[t];
+        s->len = strlen(s->str);
+        return 0;
+    }
+
+    t -= dictionary_size;
+    if (is_value) {
+        if (!(t & 1)) {
+            s->num = t >> 1;
+            s->len = integer_length(s->num);
+            return 0;
+        }
+        t >>= 1;
+    }
+
+    if (t > (uint64_t)(end - *p) || memchr(*p, '\0', (size_t)t))
+        return -1;
+    s->str = (const char*)*p;
+    s->len = (size_t)t;
+    *p += t;
+
+    return 0;
+}
+
+/*
+ * Copy s to dst as a null-terminated string.
+ */
+static void copy_string(char* dst, const serial_string* s)
+{
+    if (s->str) {
+        memcpy(dst, s->str, s->len);
+    } else {
+        uint64_t    num = s->num;
+        size_t      i = s->len;
+
+        do {
+            dst[--i] = (char)('0' + num % 10);
+            num /= 10;
+        } while (i > 0);
+    }
+    dst[s->len] = '\0';
+}
+
+/*
+ * See header file
+ */
+EDITORCONFIG_EXPORT
+size_t editorconfig_result_serialize(const editorconfig_handle h,
+        const char* const* dictionary, int dictionary_size,
+        unsigned char* buf, size_t buf_size)
+{
+    const struct editorconfig_handle*       eh =
+        (const struct editorconfig_handle*)h;
+    const struct editorconfig_result_entry* entries =
+        (const struct editorconfig_result_entry*)eh->result;
+    size_t                                  pos;
+    int                                     i;
+
+    pos = put_varint(buf, buf_size, 0, (uint64_t)eh->name_value_count);
+
+    for (i = 0; i < eh->name_value_count; ++i) {
+        const char* name = eh->result + entries[i].name_offset;
+        size_t      name_len = entries[i].name_length;
+        const char* value = eh->result + entries[i].value_offset;
+        size_t      value_len = entries[i].value_length;
+        uint64_t    num;
+        int         index;
+
+        if ((index = find_string(ec_known_names, EC_NAME_COUNT,
+                        name, name_len)) >= 0)
+            pos = put_varint(buf, buf_size, pos, (uint64_t)index);
+        else if ((index = find_string(dictionary, dictionary_size,
+                        name, name_len)) >= 0)
+            pos = put_varint(buf, buf_size, pos,
+                    (uint64_t)(NAME_SLOTS + index));
+        else {
+            pos = put_varint(buf, buf_size, pos,
+                    (uint64_t)(NAME_SLOTS + dictionary_size) + name_len);
+            pos = put_bytes(buf, buf_size, pos, name, name_len);
+        }
+
+        if ((index = find_string(ec_known_values, EC_VALUE_COUNT,
+                        value, value_len)) >= 0)
+            pos = put_varint(buf, buf_size, pos, (uint64_t)index);
+        else if ((index = find_string(dictionary, dictionary_size,
+                        value, value_len)) >= 0)
+            pos = put_varint(buf, buf_size, pos,
+                    (uint64_t)(VALUE_SLOTS + index));
+        else if (is_small_integer(value, value_len, &num))
+            pos = put_varint(buf, buf_size, pos,
+                    (uint64_t)(VALUE_SLOTS + dictionary_size) + num * 2);
+        else {
+            pos = put_varint(buf, buf_size, pos,
+                    (uint64_t)(VALUE_SLOTS + dictionary_size) +
+                    value_len * 2 + 1);
+            pos = put_bytes(buf, buf_size, pos, value, value_len);
+        }
+    }
+
+    return pos;
+}
+
+/*
+ * See header file
+ */
+EDITORCONFIG_EXPORT
+int editorconfig_result_deserialize(editorconfig_handle h,
+        const char* const* dictionary, int dictionary_size,
+        const unsigned char* buf, size_t buf_size)
+{
+    struct editorconfig_handle*         eh = (struct editorconfig_handle*)h;
+    struct editorconfig_result_entry*   entries;
+    const unsigned char*                end = buf + buf_size;
+    const unsigned char*                p = buf;
+    uint64_t                            count;
+    size_t                              size;
+    char*                               result;
+    char*                               q;
+    uint64_t                            i;
+
+    /* first pass: check the data and work out the size of the block */
+    if (get_varint(&p, end, &count) ||
+            count > (uint64_t)(end - p) / 2 || count > INT_MAX)
+        return EDITORCONFIG_PARSE_INVALID_DATA;
+
+    size = sizeof(struct editorconfig_result_entry) * (size_t)count;
+    for (i = 0; i < count; ++i) {
+        serial_string   name;
+        serial_string   value;
+
+        if (get_string(&p, end, dictionary, dictionary_size, 0, &name) ||
+                get_string(&p, end, dictionary, dictionary_size, 1, &value))
+            return EDITORCONFIG_PARSE_INVALID_DATA;
+        size += name.len + 1 + value.len + 1;
+    }
+    if (p != end || size > UINT32_MAX)
+        return EDITORCONFIG_PARSE_INVALID_DATA;
+
+    /* second pass: fill in the block */
+    result = NULL;
+    if (count > 0) {
+        result = (char*)malloc(size);
+        if (result == NULL)
+            return EDITORCONFIG_PARSE_MEMORY_ERROR;
+    }
+
+    entries = (struct editorconfig_result_entry*)result;
+    q = result + sizeof(struct editorconfig_result_entry) * (size_t)count;
+    p = buf;
+    get_varint(&p, end, &count);
+    for (i = 0; i < count; ++i) {
+        serial_string   name;
+        serial_string   value;
+
+        get_string(&p, end, dictionary, dictionary_size, 0, &name);
+        get_string(&p, end, dictionary, dictionary_size, 1, &value);
+
+        entries[i].name_offset = (uint32_t)(q - result);
+        entries[i].name_length = (uint32_t)name.len;
+        copy_string(q, &name);
+        q += name.len + 1;
+
+        entries[i].value_offset = (uint32_t)(q - result);
+        entries[i].value_length = (uint32_t)value.len;
+        copy_string(q, &value);
+        q += value.len + 1;
+    }
+
+    free(eh->result);
+    eh->result = result;
+    eh->result_size = count > 0 ? size : 0;
+    eh->name_value_count = (int)count;
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * editorconfig_coro.hpp: co_await ec::resolve() gives the same result as
+ * editorconfig_parse(), resumes through the executor it was given, and
+ * resumes right away without the executor when the request is refused.
+ *
+ * Usage: test_coro DATA_DIR
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+
+#include <editorconfig/editorconfig_coro.hpp>
+
+#include "test.h"
+
+/* a coroutine that starts right away and is not waited for */
+struct task
+{
+    struct promise_type
+    {
+        task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+/* resumes inline and counts how often it did */
+struct counting_executor
+{
+    std::atomic<int>*   calls;
+
+    void operator()(std::coroutine_handle<> h) const
+    {
+        ++ *calls;
+        h.resume();
+    }
+};
+
+static std::mutex               finished_mutex;
+static std::condition_variable  finished_cond;
+static int                      finished_count;
+
+static void finish()
+{
+    std::lock_guard<std::mutex> lock(finished_mutex);
+
+    ++ finished_count;
+    finished_cond.notify_one();
+}
+
+/* waits for count coroutines in all to finish */
+static void wait_finished(int count)
+{
+    std::unique_lock<std::mutex> lock(finished_mutex);
+
+    finished_cond.wait(lock, [count] { return finished_count >= count; });
+}
+
+static task resolve_c_file(std::string path, std::atomic<int>* calls)
+{
+    ec::result  r = co_await ec::resolve(path, {}, counting_executor{ calls });
+    ec::result  moved;
+
+    CHECK(r);
+    CHECK(r.error() == 0);
+    CHECK(r.size() == 4);
+    CHECK(r.value("indent_style") == "space");
+    CHECK(r.value("indent_size") == "4");
+    CHECK(!r.value("charset"));
+
+    /* moving hands over the handle */
+    moved = std::move(r);
+    CHECK(!r);
+    CHECK(moved.value("end_of_line") == "lf");
+
+    finish();
+}
+
+static task resolve_refused(std::string path, ec::options opts, int expected,
+        std::atomic<int>* calls)
+{
+    ec::result  r = co_await ec::resolve(path, opts,
+            counting_executor{ calls });
+
+    CHECK(!r);
+    CHECK(r.error() == expected);
+    CHECK_STR(r.error_message(), editorconfig_get_error_msg(expected));
+
+    finish();
+}
+
+int main(int argc, char* argv[])
+{
+    std::atomic<int>    calls(0);
+    std::string         c_file;
+    ec::options         too_new;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    c_file = std::string(argv[1]) + "/tree/a.c";
+
+    /* resumed by the executor on the library's queue */
+    resolve_c_file(c_file, &calls);
+    resolve_c_file(c_file, &calls);
+    wait_finished(2);
+    CHECK(calls == 2);
+
+    /* refused up front: resumed before resolve() returns, no executor */
+    resolve_refused("relative/a.c", {}, EDITORCONFIG_PARSE_NOT_FULL_PATH,
+            &calls);
+    too_new.version_major = 1000;
+    resolve_refused(c_file, too_new, EDITORCONFIG_PARSE_VERSION_TOO_NEW,
+            &calls);
+    CHECK(finished_count == 4);
+    CHECK(calls == 2);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * The daemon of the command line tool, run in a child process: its answers
+ * are the results editorconfig_parse() gives in process, errors included,
+ * its socket is only accessible to its user, a second daemon doesn't take
+ * over the socket, and it goes away when idle. When run as root, also
+ * checks that a daemon of another user is not trusted.
+ *
+ * Usage: test_daemon DATA_DIR
+ */
+
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "daemon.h"
+
+#include "test.h"
+
+/* the user a daemon of another user runs as */
+#define OTHER_UID       65534
+
+/* seconds to wait for a daemon to start or to go away */
+#define WAIT_SECONDS    10
+
+static char* join_path(const char* dir, const char* name)
+{
+    char*   path = (char*)malloc(strlen(dir) + strlen(name) + 2);
+
+    sprintf(path, "%s/%s", dir, name);
+    return path;
+}
+
+/* starts a daemon on socket_path in a child process, running as uid unless
+ * that is -1 */
+static pid_t start_daemon(const char* socket_path, int uid)
+{
+    pid_t   pid = fork();
+    int     i;
+
+    if (pid == 0) {
+        if (uid != -1 && (setgid(uid) || setuid(uid)))
+            _exit(1);
+        _exit(daemon_serve(socket_path, 1));
+    }
+
+    /* it is up once the socket file is there */
+    for (i = 0; i < WAIT_SECONDS * 10; ++i) {
+        struct stat st;
+
+        if (stat(socket_path, &st) == 0)
+            break;
+        usleep(100000);
+    }
+
+    return pid;
+}
+
+/* waits for the daemon pid to exit on its own, returns its exit status */
+static int wait_daemon(pid_t pid)
+{
+    int     status;
+    int     i;
+
+    for (i = 0; i < WAIT_SECONDS * 10; ++i) {
+        if (waitpid(pid, &status, WNOHANG) == pid)
+            return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        usleep(100000);
+    }
+
+    kill(pid, SIGKILL);
+    waitpid(pid, &status, 0);
+    return -1;
+}
+
+/* checks that the daemon answers full_filename as editorconfig_parse()
+ * does, with the conf file name and version of settings */
+static void check_same_answer(daemon_client* client, const char* full_filename,
+        editorconfig_handle settings)
+{
+    editorconfig_handle local = editorconfig_handle_init();
+    editorconfig_handle remote = editorconfig_handle_init();
+    int                 major;
+    int                 minor;
+    int                 patch;
+    int                 err_num;
+    int                 i;
+
+    editorconfig_handle_get_version(settings, &major, &minor, &patch);
+    editorconfig_handle_set_version(local, major, minor, patch);
+    editorconfig_handle_set_version(remote, major, minor, patch);
+    editorconfig_handle_set_conf_file_name(local,
+            editorconfig_handle_get_conf_file_name(settings));
+    editorconfig_handle_set_conf_file_name(remote,
+            editorconfig_handle_get_conf_file_name(settings));
+
+    err_num = editorconfig_parse(full_filename, local);
+    CHECK(daemon_client_parse(client, full_filename, remote) == err_num);
+    if (err_num == 0) {
+        CHECK(editorconfig_handle_get_name_value_count(remote) ==
+                editorconfig_handle_get_name_value_count(local));
+        for (i = 0; i < editorconfig_handle_get_name_value_count(local);
+                ++i) {
+            const char* local_name;
+            const char* local_value;
+            const char* remote_name;
+            const char* remote_value;
+
+            editorconfig_handle_get_name_value(local, i, &local_name,
+                    &local_value);
+            editorconfig_handle_get_name_value(remote, i, &remote_name,
+                    &remote_value);
+            CHECK_STR(remote_name, local_name);
+            CHECK_STR(remote_value, local_value);
+        }
+    }
+
+    editorconfig_handle_destroy(local);
+    editorconfig_handle_destroy(remote);
+}
+
+int main(int argc, char* argv[])
+{
+    static const char* const    names[] = {
+        "tree/a.c", "tree/b.py", "tree/c.mk", "tree/sub/d.c",
+        "bad_syntax/x.c"
+    };
+    editorconfig_handle         settings = editorconfig_handle_init();
+    char                        dir[] = "/tmp/test_daemon.XXXXXX";
+    char*                       socket_path;
+    char*                       path;
+    daemon_client               client;
+    struct stat                 st;
+    pid_t                       pid;
+    size_t                      i;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    if (mkdtemp(dir) == NULL) {
+        perror(dir);
+        return 2;
+    }
+    socket_path = join_path(dir, "socket");
+
+    /* nothing to connect to yet */
+    CHECK(daemon_client_connect(&client, socket_path) == -1);
+    CHECK(daemon_client_parse(&client, "/a.c", settings) ==
+            DAEMON_UNAVAILABLE);
+    daemon_client_close(&client);
+
+    pid = start_daemon(socket_path, -1);
+    CHECK(stat(socket_path, &st) == 0);
+    CHECK(S_ISSOCK(st.st_mode));
+    CHECK((st.st_mode & 0777) == 0600);
+
+    /* a second daemon leaves the socket to the first one */
+    CHECK(daemon_serve(socket_path, 1) == 1);
+
+    CHECK(daemon_client_connect(&client, socket_path) == 0);
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        path = join_path(argv[1], names[i]);
+
+        /* as is, with an older version and with another conf file name */
+        editorconfig_handle_set_version(settings, 0, 0, 0);
+        editorconfig_handle_set_conf_file_name(settings, NULL);
+        check_same_answer(&client, path, settings);
+        editorconfig_handle_set_version(settings, 0, 8, 0);
+        check_same_answer(&client, path, settings);
+        editorconfig_handle_set_version(settings, 0, 0, 0);
+        editorconfig_handle_set_conf_file_name(settings, "none.ini");
+        check_same_answer(&client, path, settings);
+
+        free(path);
+    }
+    editorconfig_handle_set_conf_file_name(settings, NULL);
+    check_same_answer(&client, "relative/a.c", settings);
+    daemon_client_close(&client);
+
+    /* the daemon goes away once no client has been connected for a while */
+    CHECK(wait_daemon(pid) == 0);
+    CHECK(stat(socket_path, &st) != 0);
+
+    /* as root, a daemon of another user is not asked */
+    if (geteuid() == 0 && chown(dir, OTHER_UID, OTHER_UID) == 0) {
+        pid = start_daemon(socket_path, OTHER_UID);
+        CHECK(stat(socket_path, &st) == 0);
+        CHECK(daemon_client_connect(&client, socket_path) == -1);
+        daemon_client_close(&client);
+        CHECK(wait_daemon(pid) == 0);
+    }
+
+    rmdir(dir);
+    editorconfig_handle_destroy(settings);
+    free(socket_path);
+
+    return TEST_RESULT();
+}
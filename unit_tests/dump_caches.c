@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * editorconfig_dump_caches(): the files and glob patterns a lookup cached
+ * are listed with what they hold, missing files as such, and their hits
+ * count the lookups that reused them.
+ *
+ * Usage: test_dump_caches DATA_DIR
+ */
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+/* what the visitors saw of the entries looked for */
+typedef struct
+{
+    /* data/.editorconfig, data/tree/.editorconfig and
+     * data/bad_glob/.editorconfig */
+    const char*                     conf;
+    const char*                     missing;
+    const char*                     bad_glob;
+    editorconfig_file_cache_entry   conf_entry;
+    editorconfig_file_cache_entry   missing_entry;
+    editorconfig_file_cache_entry   bad_glob_entry;
+    int                             files;
+    int                             globs;
+    int                             uncompiled_globs;
+    int                             bad_entries;
+} dump;
+
+static void visit_file(const editorconfig_file_cache_entry* entry, void* user)
+{
+    dump*   d = (dump*)user;
+
+    ++ d->files;
+    if (entry->path[0] != '/' || entry->age_ns < entry->idle_ns)
+        ++ d->bad_entries;
+
+    /* the strings are only valid during the call */
+    if (strcmp(entry->path, d->conf) == 0)
+        d->conf_entry = *entry;
+    else if (strcmp(entry->path, d->missing) == 0)
+        d->missing_entry = *entry;
+    else if (strcmp(entry->path, d->bad_glob) == 0)
+        d->bad_glob_entry = *entry;
+}
+
+static void visit_glob(const editorconfig_glob_cache_entry* entry, void* user)
+{
+    dump*   d = (dump*)user;
+
+    ++ d->globs;
+    if (entry->pattern[0] != '/')
+        ++ d->bad_entries;
+    if (entry->compiled_size == 0)
+        ++ d->uncompiled_globs;
+}
+
+static char* data_path(const char* data_dir, const char* name)
+{
+    char*   path = (char*)malloc(strlen(data_dir) + strlen(name) + 2);
+
+    sprintf(path, "%s/%s", data_dir, name);
+    return path;
+}
+
+static void take_dump(dump* d)
+{
+    /* what is not seen reads as -1 */
+    memset(&d->conf_entry, 0xff, sizeof(d->conf_entry));
+    memset(&d->missing_entry, 0xff, sizeof(d->missing_entry));
+    memset(&d->bad_glob_entry, 0xff, sizeof(d->bad_glob_entry));
+    d->files = d->globs = d->uncompiled_globs = d->bad_entries = 0;
+    editorconfig_dump_caches(visit_glob, visit_file, d);
+}
+
+int main(int argc, char* argv[])
+{
+    editorconfig_handle h = editorconfig_handle_init();
+    dump                d;
+    struct stat         st;
+    char*               a_c;
+    char*               bad_glob_c;
+    int                 files;
+    int                 globs;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    a_c = data_path(argv[1], "tree/a.c");
+    bad_glob_c = data_path(argv[1], "bad_glob/x.c");
+    d.conf = data_path(argv[1], ".editorconfig");
+    d.missing = data_path(argv[1], "tree/.editorconfig");
+    d.bad_glob = data_path(argv[1], "bad_glob/.editorconfig");
+    CHECK(stat(d.conf, &st) == 0);
+
+    /* nothing cached yet */
+    editorconfig_clear_caches();
+    take_dump(&d);
+    CHECK(d.files == 0);
+    CHECK(d.globs == 0);
+
+    /* a lookup caches every directory up to the root, and the patterns of
+     * the files it found */
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    take_dump(&d);
+    files = d.files;
+    globs = d.globs;
+    CHECK(files >= 3);
+    CHECK(globs >= 6);
+    CHECK(d.uncompiled_globs == 0);
+    CHECK(d.bad_entries == 0);
+    CHECK(d.conf_entry.exists == 1);
+    CHECK(d.conf_entry.watch == EDITORCONFIG_CACHE_WATCH_FILE);
+    CHECK(d.conf_entry.bytes == (unsigned long long)st.st_size);
+    CHECK(d.conf_entry.hits == 0);
+    CHECK(d.missing_entry.exists == 0);
+    CHECK(d.missing_entry.watch == EDITORCONFIG_CACHE_WATCH_DIRECTORY);
+    CHECK(d.missing_entry.bytes == 0);
+    CHECK(d.missing_entry.sections == 0);
+    CHECK(d.missing_entry.hits == 0);
+
+    /* the same lookup and one in a sibling directory reuse what is cached;
+     * a pattern that does not compile is cached as such. The sections of
+     * bad_glob/.editorconfig are the one holding root = true and two more */
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(editorconfig_parse(bad_glob_c, h) == 0);
+    take_dump(&d);
+    CHECK(d.files == files + 1);
+    CHECK(d.globs == globs + 2);
+    CHECK(d.uncompiled_globs == 1);
+    CHECK(d.bad_entries == 0);
+    CHECK(d.conf_entry.hits == 2);
+    CHECK(d.missing_entry.hits == 1);
+    CHECK(d.bad_glob_entry.exists == 1);
+    CHECK(d.bad_glob_entry.sections == 3);
+    CHECK(d.bad_glob_entry.properties == 3);
+    CHECK(d.bad_glob_entry.hits == 0);
+
+    editorconfig_handle_destroy(h);
+    free(a_c);
+    free(bad_glob_c);
+    free((char*)d.conf);
+    free((char*)d.missing);
+    free((char*)d.bad_glob);
+
+    return TEST_RESULT();
+}
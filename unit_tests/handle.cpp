@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * editorconfig.hpp: ec::handle gives the result of editorconfig_parse() as
+ * string_view pairs, hands its handle over when moved and throws the error
+ * editorconfig_parse() returned.
+ *
+ * Usage: test_handle DATA_DIR
+ */
+
+#include <string>
+#include <utility>
+
+#include <editorconfig/editorconfig.hpp>
+
+#include "test.h"
+
+int main(int argc, char* argv[])
+{
+    std::string data_dir;
+    ec::handle  h;
+    ec::handle  moved;
+    ec::version v;
+    int         n = 0;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    data_dir = argv[1];
+
+    /* the settings are those of the C handle */
+    CHECK(h);
+    CHECK(h.empty());
+    CHECK(h.conf_file_name() == NULL);
+    h.set_version(0, 12, 0);
+    v = h.version();
+    CHECK(v.major == 0 && v.minor == 12 && v.patch == 0);
+
+    /* properties, in order, by index and by name */
+    h.parse(data_dir + "/tree/a.c");
+    CHECK(h.size() == 4);
+    for (ec::property p : h) {
+        const char* name;
+        const char* value;
+
+        editorconfig_handle_get_name_value(h.get(), n++, &name, &value);
+        CHECK(p.name == name);
+        CHECK(p.value == value);
+        CHECK(p.name.data() == name);   /* a view, not a copy */
+    }
+    CHECK(n == 4);
+    CHECK(h[0].name == "end_of_line");
+    CHECK(h[0].value == "lf");
+    CHECK(h.find("indent_size") != h.end());
+    CHECK((*h.find("indent_size")).value == "4");
+    CHECK(h.find("charset") == h.end());
+    CHECK(h.value("indent_style") == "space");
+    CHECK(!h.value("charset"));
+
+    /* a new parse replaces the result */
+    h.parse(data_dir + "/tree/b.py");
+    CHECK(h.size() == 4);
+
+    /* moving hands over the handle */
+    moved = std::move(h);
+    CHECK(!h);
+    CHECK(h.size() == 0);
+    CHECK(moved.value("indent_style") == "space");
+
+    /* errors, with the file and line of a syntax error */
+    try {
+        moved.parse("relative/a.c");
+        CHECK(!"no exception");
+    } catch (const ec::parse_error&) {
+        CHECK(!"parse_error");
+    } catch (const ec::error& e) {
+        CHECK(e.code() == EDITORCONFIG_PARSE_NOT_FULL_PATH);
+        CHECK_STR(e.what(),
+                editorconfig_get_error_msg(EDITORCONFIG_PARSE_NOT_FULL_PATH));
+    }
+    try {
+        moved.parse(data_dir + "/bad_syntax/x.c");
+        CHECK(!"no exception");
+    } catch (const ec::parse_error& e) {
+        CHECK(e.line() == 5);
+        CHECK(e.code() == 5);
+        CHECK(e.file().find("bad_syntax") != std::string::npos);
+    }
+
+    /* release() gives up ownership */
+    editorconfig_handle_destroy(moved.release());
+    CHECK(!moved);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * ec_intern() keeps one copy of each string: equal strings give the same
+ * pointer, and the names and values EditorConfig knows about give the
+ * entries of ec_known_names and ec_known_values. A string stays while it is
+ * held, however many others come and go. Calls into the library internals,
+ * so this links to the static library.
+ */
+
+#include "global.h"
+#include "intern.h"
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+int main(void)
+{
+    char        buf[32];
+    const char* first;
+    const char* held;
+    int         i;
+
+    /* the known strings are their own interned copies */
+    for (i = 0; i < EC_NAME_COUNT; ++i)
+        CHECK(ec_intern(ec_known_names[i], strlen(ec_known_names[i])) ==
+                ec_known_names[i]);
+    for (i = 0; i < EC_VALUE_COUNT; ++i)
+        CHECK(ec_intern(ec_known_values[i], strlen(ec_known_values[i])) ==
+                ec_known_values[i]);
+
+    /* whatever buffer they come from */
+    strcpy(buf, "indent_style");
+    CHECK(ec_intern(buf, strlen(buf)) == ec_known_names[EC_NAME_INDENT_STYLE]);
+    strcpy(buf, "tabXYZ");
+    CHECK(ec_intern(buf, 3) == ec_known_values[EC_VALUE_TAB]);
+
+    /* and regardless of case when asked for lowercase */
+    strcpy(buf, "UTF-8-BOM");
+    CHECK(ec_intern_lower(buf, strlen(buf)) ==
+            ec_known_values[EC_VALUE_UTF_8_BOM]);
+    CHECK(ec_intern_lower("CRLF", 4) == ec_known_values[EC_VALUE_CRLF]);
+
+    /* unknown strings are added once */
+    strcpy(buf, "custom_property");
+    first = ec_intern(buf, strlen(buf));
+    CHECK_STR(first, "custom_property");
+    CHECK(first != buf);
+    strcpy(buf, "custom_property");
+    CHECK(ec_intern(buf, strlen(buf)) == first);
+    CHECK(ec_intern("custom_property", strlen("custom_property")) == first);
+    CHECK(ec_intern_lower("Custom_Property", strlen("Custom_Property")) ==
+            first);
+
+    /* the length counts, not the terminator */
+    first = ec_intern("custom", 6);
+    CHECK_STR(first, "custom");
+    CHECK(ec_intern("custom_property", 6) == first);
+    CHECK(ec_intern("", 0) != NULL && *ec_intern("", 0) == '\0');
+
+    /* a held string outlives many strings that are let go of at once, which
+     * makes the table drop them rather than grow */
+    held = ec_intern("held", 4);
+    for (i = 0; i < 100000; ++i) {
+        sprintf(buf, "released_%d", i);
+        first = ec_intern(buf, strlen(buf));
+        CHECK_STR(first, buf);
+        ec_intern_release(first);
+    }
+    CHECK(ec_intern("held", 4) == held);
+    ec_intern_release(held);
+    CHECK_STR(held, "held");
+
+    /* and clearing drops only what is not held */
+    ec_intern_clear();
+    CHECK(ec_intern("held", 4) == held);
+    CHECK_STR(held, "held");
+    first = ec_intern("released_7", strlen("released_7"));
+    CHECK_STR(first, "released_7");
+    ec_intern_release(first);
+
+    /* the known strings are never dropped, releasing them does nothing */
+    ec_intern_release(ec_known_names[EC_NAME_CHARSET]);
+    ec_intern_clear();
+    CHECK(ec_intern("charset", 7) == ec_known_names[EC_NAME_CHARSET]);
+
+    return TEST_RESULT();
+}
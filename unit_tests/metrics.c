@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * editorconfig_metrics_snapshot(): the counters are those of the lookups
+ * made, the length it returns is that of the full text whatever the size of
+ * the buffer, and a text that does not fit is cut short and still
+ * null-terminated.
+ *
+ * Usage: test_metrics DATA_DIR
+ */
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+int main(int argc, char* argv[])
+{
+    editorconfig_handle h = editorconfig_handle_init();
+    char*               path;
+    char*               full;
+    const char*         evictions;
+    char                dir[] = "/tmp/test_metrics.XXXXXX";
+    char                small[16];
+    char                one = 'x';
+    size_t              len;
+    int                 i;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    path = (char*)malloc(strlen(argv[1]) + sizeof("/tree/a.c"));
+    sprintf(path, "%s/tree/a.c", argv[1]);
+
+    /* something to count, with all the histograms */
+    editorconfig_metrics_set_phase_timing(1);
+    CHECK(editorconfig_parse(path, h) == 0);
+    CHECK(editorconfig_parse("relative/a.c", h) ==
+            EDITORCONFIG_PARSE_NOT_FULL_PATH);
+
+    len = editorconfig_metrics_snapshot(NULL, 0);
+    CHECK(len > sizeof(small));
+
+    full = (char*)malloc(len + 1);
+    memset(full, 'x', len + 1);
+    CHECK(editorconfig_metrics_snapshot(full, len + 1) == len);
+    CHECK(strlen(full) == len);
+    CHECK(strstr(full, "# TYPE editorconfig_queries_total counter\n") != NULL);
+    CHECK(strstr(full, "editorconfig_phase_duration_seconds_bucket{") !=
+            NULL);
+    CHECK(strstr(full, "le=\"+Inf\"") != NULL);
+    CHECK(full[len - 1] == '\n');
+
+    /* the two lookups above are all this process did */
+    CHECK(strstr(full, "\neditorconfig_queries_total 2\n") != NULL);
+    CHECK(strstr(full, "\neditorconfig_errors_total{code=\"-2\"} 1\n") !=
+            NULL);
+    CHECK(strstr(full,
+                "\neditorconfig_cache_evictions_total{cache=\"file\"} 0\n") !=
+            NULL);
+
+    /* one byte short of the terminator: the last character is cut */
+    memset(full, 'x', len + 1);
+    CHECK(editorconfig_metrics_snapshot(full, len) == len);
+    CHECK(strlen(full) == len - 1);
+
+    /* cut short, but the same text as far as it goes */
+    memset(small, 'x', sizeof(small));
+    CHECK(editorconfig_metrics_snapshot(small, sizeof(small)) == len);
+    CHECK(small[sizeof(small) - 1] == '\0');
+    CHECK(strncmp(small, full, sizeof(small) - 1) == 0);
+
+    /* only room for the terminator */
+    CHECK(editorconfig_metrics_snapshot(&one, 1) == len);
+    CHECK(one == '\0');
+
+    /* the missing config files of many directories don't all stay cached,
+     * those dropped to bound the cache count as evictions */
+    CHECK(mkdtemp(dir) != NULL);
+    path = (char*)realloc(path, sizeof(dir) + sizeof("/999/x.c"));
+    for (i = 0; i < 300; ++i) {
+        sprintf(path, "%s/%d", dir, i);
+        CHECK(mkdir(path, 0700) == 0);
+        strcat(path, "/x.c");
+        CHECK(editorconfig_parse(path, h) == 0);
+    }
+    len = editorconfig_metrics_snapshot(NULL, 0);
+    full = (char*)realloc(full, len + 1);
+    editorconfig_metrics_snapshot(full, len + 1);
+    evictions = strstr(full,
+            "\neditorconfig_cache_evictions_total{cache=\"file\"} ");
+    CHECK(evictions != NULL);
+    if (evictions != NULL)
+        CHECK(atoi(strchr(evictions, '}') + 2) >= 300 - 256);
+
+    /* let go of the directories before they are removed */
+    editorconfig_clear_caches();
+    for (i = 0; i < 300; ++i) {
+        sprintf(path, "%s/%d", dir, i);
+        rmdir(path);
+    }
+    rmdir(dir);
+
+    editorconfig_metrics_set_phase_timing(0);
+    editorconfig_handle_destroy(h);
+    free(path);
+    free(full);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * editorconfig_parse_async(): the callback gets a handle with the result,
+ * also when several lookups of the same directory share the work, and
+ * arguments that are refused up front are never called back.
+ *
+ * Usage: test_parse_async DATA_DIR
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+/* how many lookups of the same directory are started at once */
+#define BATCH_SIZE      8
+
+static pthread_mutex_t  done_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   done_cond = PTHREAD_COND_INITIALIZER;
+static int              done_count;
+static int              done_failures;
+static int              done_user_total;
+
+/* user points at the count of values the result should have */
+static void parsed(const char* full_filename, int err_num,
+        editorconfig_handle result, void* user)
+{
+    int     expected = *(const int*)user;
+
+    (void)full_filename;
+
+    pthread_mutex_lock(&done_mutex);
+    if (err_num != 0 || result == NULL ||
+            editorconfig_handle_get_name_value_count(result) != expected)
+        ++ done_failures;
+    done_user_total += expected;
+    ++ done_count;
+    pthread_cond_signal(&done_cond);
+    pthread_mutex_unlock(&done_mutex);
+
+    if (result)
+        editorconfig_handle_destroy(result);
+}
+
+/* waits for count callbacks in all */
+static void wait_done(int count)
+{
+    pthread_mutex_lock(&done_mutex);
+    while (done_count < count)
+        pthread_cond_wait(&done_cond, &done_mutex);
+    pthread_mutex_unlock(&done_mutex);
+}
+
+static char* data_path(const char* data_dir, const char* name)
+{
+    char*   path = (char*)malloc(strlen(data_dir) + strlen(name) + 2);
+
+    sprintf(path, "%s/%s", data_dir, name);
+    return path;
+}
+
+int main(int argc, char* argv[])
+{
+    editorconfig_handle options = editorconfig_handle_init();
+    char*               paths[BATCH_SIZE];
+    int                 four = 4;
+    int                 started = 0;
+    int                 i;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+
+    /* files of the same directory, cold and then from the cache */
+    for (i = 0; i < BATCH_SIZE; ++i) {
+        paths[i] = data_path(argv[1], i % 2 ? "tree/a.c" : "tree/b.py");
+        CHECK(editorconfig_parse_async(paths[i], NULL, parsed, &four) == 0);
+        ++ started;
+    }
+    wait_done(started);
+    for (i = 0; i < BATCH_SIZE; ++i) {
+        CHECK(editorconfig_parse_async(paths[i], NULL, parsed, &four) == 0);
+        ++ started;
+    }
+    wait_done(started);
+    CHECK(done_count == started);
+    CHECK(done_failures == 0);
+    CHECK(done_user_total == 4 * started);
+
+    /* refused up front, done is never called */
+    CHECK(editorconfig_parse_async("relative/a.c", NULL, parsed, &four) ==
+            EDITORCONFIG_PARSE_NOT_FULL_PATH);
+    CHECK(editorconfig_parse_async(paths[0], NULL, NULL, NULL) ==
+            EDITORCONFIG_PARSE_INVALID_ARGUMENT);
+    CHECK(editorconfig_parse_async(NULL, NULL, parsed, &four) ==
+            EDITORCONFIG_PARSE_INVALID_ARGUMENT);
+    editorconfig_handle_set_version(options, 1000, 0, 0);
+    CHECK(editorconfig_parse_async(paths[0], options, parsed, &four) ==
+            EDITORCONFIG_PARSE_VERSION_TOO_NEW);
+    CHECK(done_count == started);
+
+    editorconfig_handle_destroy(options);
+    for (i = 0; i < BATCH_SIZE; ++i)
+        free(paths[i]);
+
+    return TEST_RESULT();
+}
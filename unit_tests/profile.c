@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * editorconfig_profile_dump(): while profiling is on, each section of each
+ * config file gets the attempts to match it and the matches, costliest
+ * first; nothing is gathered while it is off, and resetting forgets it all.
+ *
+ * Usage: test_profile DATA_DIR
+ */
+
+#include <stdlib.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+/* what the visitor saw */
+typedef struct
+{
+    const char*         conf;   /* data/.editorconfig */
+    int                 entries;
+    int                 out_of_order;
+    int                 inconsistent;
+    unsigned long long  last_match_ns;
+    /* attempts and matches of some sections of conf, -1 if not seen */
+    long long           any_attempts;
+    long long           any_matches;
+    long long           c_attempts;
+    long long           c_matches;
+    long long           mk_attempts;
+    long long           mk_matches;
+    long long           sub_attempts;
+    long long           sub_matches;
+} profile;
+
+static void visit(const editorconfig_profile_entry* entry, void* user)
+{
+    profile*    p = (profile*)user;
+
+    if (p->entries++ > 0 && entry->match_ns > p->last_match_ns)
+        ++ p->out_of_order;
+    p->last_match_ns = entry->match_ns;
+    if (entry->matches > entry->attempts ||
+            entry->max_match_ns > entry->match_ns)
+        ++ p->inconsistent;
+
+    if (strcmp(entry->config_file, p->conf) != 0)
+        return;
+    if (strcmp(entry->section, "*") == 0) {
+        p->any_attempts = (long long)entry->attempts;
+        p->any_matches = (long long)entry->matches;
+    } else if (strcmp(entry->section, "*.c") == 0) {
+        p->c_attempts = (long long)entry->attempts;
+        p->c_matches = (long long)entry->matches;
+    } else if (strcmp(entry->section, "*.mk") == 0) {
+        p->mk_attempts = (long long)entry->attempts;
+        p->mk_matches = (long long)entry->matches;
+    } else if (strcmp(entry->section, "tree/sub/**") == 0) {
+        p->sub_attempts = (long long)entry->attempts;
+        p->sub_matches = (long long)entry->matches;
+    }
+}
+
+static void take_profile(profile* p)
+{
+    p->entries = p->out_of_order = p->inconsistent = 0;
+    p->any_attempts = p->any_matches = -1;
+    p->c_attempts = p->c_matches = -1;
+    p->mk_attempts = p->mk_matches = -1;
+    p->sub_attempts = p->sub_matches = -1;
+    editorconfig_profile_dump(visit, p);
+}
+
+static char* data_path(const char* data_dir, const char* name)
+{
+    char*   path = (char*)malloc(strlen(data_dir) + strlen(name) + 2);
+
+    sprintf(path, "%s/%s", data_dir, name);
+    return path;
+}
+
+int main(int argc, char* argv[])
+{
+    editorconfig_handle h = editorconfig_handle_init();
+    profile             p;
+    char*               a_c;
+    char*               c_mk;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    a_c = data_path(argv[1], "tree/a.c");
+    c_mk = data_path(argv[1], "tree/c.mk");
+    p.conf = data_path(argv[1], ".editorconfig");
+
+    /* off by default */
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    take_profile(&p);
+    CHECK(p.entries == 0);
+
+    /* a section is tried once for each of its properties, [*.c] has two */
+    editorconfig_profile_set_enabled(1);
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(editorconfig_parse(c_mk, h) == 0);
+    take_profile(&p);
+    CHECK(p.entries > 4);
+    CHECK(p.out_of_order == 0);
+    CHECK(p.inconsistent == 0);
+    CHECK(p.any_attempts == 2 && p.any_matches == 2);
+    CHECK(p.c_attempts == 4 && p.c_matches == 2);
+    CHECK(p.mk_attempts == 2 && p.mk_matches == 1);
+    CHECK(p.sub_attempts == 2 && p.sub_matches == 0);
+
+    /* what was gathered is kept, but no more is once it is off */
+    editorconfig_profile_set_enabled(0);
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    take_profile(&p);
+    CHECK(p.c_attempts == 4 && p.c_matches == 2);
+
+    editorconfig_profile_reset();
+    take_profile(&p);
+    CHECK(p.entries == 0);
+
+    editorconfig_handle_destroy(h);
+    free(a_c);
+    free(c_mk);
+    free((char*)p.conf);
+
+    return TEST_RESULT();
+}
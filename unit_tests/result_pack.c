@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * The parsing result is one block without pointers: the entries come first,
+ * and each offset and length points at a null-terminated string further in
+ * the block. Looks at the handle internals, so this links to the static
+ * library.
+ *
+ * Usage: test_result_pack DATA_DIR
+ */
+
+#include "global.h"
+#include "editorconfig_handle.h"
+
+#include <stdlib.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+/* checks the layout of the result block of h */
+static void check_block(editorconfig_handle h)
+{
+    const struct editorconfig_handle*       eh =
+        (const struct editorconfig_handle*)h;
+    const struct editorconfig_result_entry* entries =
+        (const struct editorconfig_result_entry*)eh->result;
+    size_t      strings = sizeof(*entries) * (size_t)eh->name_value_count;
+    size_t      next = strings;
+    char*       copy;
+    int         i;
+
+    CHECK(eh->result_size >= strings);
+    if (eh->name_value_count == 0)
+        return;
+
+    for (i = 0; i < eh->name_value_count; ++i) {
+        const char* name;
+        const char* value;
+
+        /* the strings follow the entries, in order, with nothing between */
+        CHECK(entries[i].name_offset == next);
+        CHECK(entries[i].value_offset ==
+                entries[i].name_offset + entries[i].name_length + 1);
+        next = entries[i].value_offset + entries[i].value_length + 1;
+        CHECK(next <= eh->result_size);
+        if (next > eh->result_size)
+            return;
+
+        CHECK(strlen(eh->result + entries[i].name_offset) ==
+                entries[i].name_length);
+        CHECK(strlen(eh->result + entries[i].value_offset) ==
+                entries[i].value_length);
+
+        editorconfig_handle_get_name_value(h, i, &name, &value);
+        CHECK(name == eh->result + entries[i].name_offset);
+        CHECK(value == eh->result + entries[i].value_offset);
+    }
+    CHECK(next == eh->result_size);
+
+    /* a copy of the block reads the same */
+    copy = (char*)malloc(eh->result_size);
+    memcpy(copy, eh->result, eh->result_size);
+    for (i = 0; i < eh->name_value_count; ++i) {
+        const char* name;
+        const char* value;
+
+        editorconfig_handle_get_name_value(h, i, &name, &value);
+        CHECK_STR(copy + entries[i].name_offset, name);
+        CHECK_STR(copy + entries[i].value_offset, value);
+    }
+    free(copy);
+}
+
+int main(int argc, char* argv[])
+{
+    editorconfig_handle h = editorconfig_handle_init();
+    editorconfig_handle decoded = editorconfig_handle_init();
+    char*               path;
+    unsigned char*      buf;
+    size_t              size;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    path = (char*)malloc(strlen(argv[1]) + sizeof("/tree/b.py"));
+
+    sprintf(path, "%s/tree/a.c", argv[1]);
+    CHECK(editorconfig_parse(path, h) == 0);
+    CHECK(editorconfig_handle_get_name_value_count(h) == 4);
+    check_block(h);
+
+    /* a deserialized result is laid out the same way */
+    size = editorconfig_result_serialize(h, NULL, 0, NULL, 0);
+    buf = (unsigned char*)malloc(size);
+    editorconfig_result_serialize(h, NULL, 0, buf, size);
+    CHECK(editorconfig_result_deserialize(decoded, NULL, 0, buf, size) == 0);
+    check_block(decoded);
+
+    /* and so is the next result in the same handle */
+    sprintf(path, "%s/tree/b.py", argv[1]);
+    CHECK(editorconfig_parse(path, h) == 0);
+    CHECK(editorconfig_handle_get_name_value_count(h) == 4);
+    check_block(h);
+
+    /* and so is a smaller one */
+    sprintf(path, "%s/tree/none", argv[1]);
+    CHECK(editorconfig_parse(path, h) == 0);
+    CHECK(editorconfig_handle_get_name_value_count(h) == 1);
+    check_block(h);
+
+    editorconfig_handle_destroy(h);
+    editorconfig_handle_destroy(decoded);
+    free(path);
+    free(buf);
+
+    return TEST_RESULT();
+}
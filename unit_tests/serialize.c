@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * editorconfig_result_serialize() and editorconfig_result_deserialize():
+ * results survive the round trip with and without a dictionary, and data
+ * that is cut short or has bytes left over is rejected.
+ *
+ * Usage: test_serialize DATA_DIR
+ */
+
+#include <stdlib.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+/* checks that a and b hold the same names and values in the same order */
+static void check_same_result(editorconfig_handle a, editorconfig_handle b)
+{
+    int     count = editorconfig_handle_get_name_value_count(a);
+    int     i;
+
+    CHECK(editorconfig_handle_get_name_value_count(b) == count);
+    if (editorconfig_handle_get_name_value_count(b) != count)
+        return;
+
+    for (i = 0; i < count; ++i) {
+        const char* a_name;
+        const char* a_value;
+        const char* b_name;
+        const char* b_value;
+
+        editorconfig_handle_get_name_value(a, i, &a_name, &a_value);
+        editorconfig_handle_get_name_value(b, i, &b_name, &b_value);
+        CHECK_STR(a_name, b_name);
+        CHECK_STR(a_value, b_value);
+    }
+}
+
+/* serializes the result of h, the caller frees it */
+static unsigned char* serialize(editorconfig_handle h,
+        const char* const* dictionary, int dictionary_size, size_t* size)
+{
+    unsigned char*  buf;
+
+    *size = editorconfig_result_serialize(h, dictionary, dictionary_size,
+            NULL, 0);
+    buf = (unsigned char*)malloc(*size + 1);
+    CHECK(editorconfig_result_serialize(h, dictionary, dictionary_size,
+                buf, *size) == *size);
+
+    return buf;
+}
+
+int main(int argc, char* argv[])
+{
+    static const char* const dictionary[] = { "custom_name", "Some Value" };
+    editorconfig_handle parsed = editorconfig_handle_init();
+    editorconfig_handle decoded = editorconfig_handle_init();
+    char*               path;
+    unsigned char*      plain;
+    unsigned char*      packed;
+    unsigned char       small[4];
+    size_t              plain_size;
+    size_t              packed_size;
+    size_t              len;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    path = (char*)malloc(strlen(argv[1]) + sizeof("/serialize.txt"));
+    sprintf(path, "%s/serialize.txt", argv[1]);
+
+    /* known names and values, small and huge numbers, and strings that are
+     * only known to the dictionary */
+    CHECK(editorconfig_parse(path, parsed) == 0);
+    CHECK(editorconfig_handle_get_name_value_count(parsed) == 7);
+
+    plain = serialize(parsed, NULL, 0, &plain_size);
+    CHECK(editorconfig_result_deserialize(decoded, NULL, 0, plain,
+                plain_size) == 0);
+    check_same_result(parsed, decoded);
+
+    packed = serialize(parsed, dictionary, 2, &packed_size);
+    CHECK(packed_size < plain_size);
+    CHECK(editorconfig_result_deserialize(decoded, dictionary, 2, packed,
+                packed_size) == 0);
+    check_same_result(parsed, decoded);
+
+    /* a buffer that is too small gets what fits, and the full size */
+    CHECK(editorconfig_result_serialize(parsed, NULL, 0, small,
+                sizeof(small)) == plain_size);
+    CHECK(memcmp(small, plain, sizeof(small)) == 0);
+
+    /* every truncation is rejected, and leaves the handle as it was */
+    for (len = 0; len < plain_size; ++len)
+        CHECK(editorconfig_result_deserialize(decoded, NULL, 0, plain,
+                    len) == EDITORCONFIG_PARSE_INVALID_DATA);
+    check_same_result(parsed, decoded);
+
+    /* and so are bytes after the end */
+    plain[plain_size] = 0;
+    CHECK(editorconfig_result_deserialize(decoded, NULL, 0, plain,
+                plain_size + 1) == EDITORCONFIG_PARSE_INVALID_DATA);
+
+    /* a count larger than the data can hold */
+    memset(small, 0xff, sizeof(small));
+    CHECK(editorconfig_result_deserialize(decoded, NULL, 0, small,
+                sizeof(small)) == EDITORCONFIG_PARSE_INVALID_DATA);
+
+    /* an empty result */
+    small[0] = 0;
+    CHECK(editorconfig_result_deserialize(decoded, NULL, 0, small, 1) == 0);
+    CHECK(editorconfig_handle_get_name_value_count(decoded) == 0);
+
+    editorconfig_handle_destroy(parsed);
+    editorconfig_handle_destroy(decoded);
+    free(path);
+    free(plain);
+    free(packed);
+
+    return TEST_RESULT();
+}
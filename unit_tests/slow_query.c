@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * editorconfig_set_slow_query_callback(): lookups over the threshold are
+ * reported with the conf files looked for and their statistics, failed ones
+ * too, the callback may do lookups of its own, and nothing is reported under
+ * the threshold or once the callback is removed.
+ *
+ * Usage: test_slow_query DATA_DIR
+ */
+
+#include <stdlib.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+/* what the callback saw */
+typedef struct
+{
+    const char*         nested_path;    /* looked up from the callback */
+    int                 calls;
+    int                 nested_calls;
+    int                 depth;
+    int                 err_num;
+    int                 config_files;
+    int                 first_is_root;
+    char                last_config_file[4096];
+    unsigned long long  ancestors;
+    unsigned long long  total_ns;
+} reports;
+
+static void slow(const editorconfig_slow_query* query, void* user)
+{
+    reports*    r = (reports*)user;
+    int         i;
+
+    if (r->depth > 0) {
+        ++ r->nested_calls;
+        return;
+    }
+
+    ++ r->calls;
+    r->err_num = query->err_num;
+    r->ancestors = query->stats.ancestors;
+    r->total_ns = query->stats.total_ns;
+    r->config_files = -1;
+    r->first_is_root = 0;
+    r->last_config_file[0] = '\0';
+    if (query->config_files != NULL) {
+        for (i = 0; query->config_files[i] != NULL; ++i)
+            snprintf(r->last_config_file, sizeof(r->last_config_file), "%s",
+                    query->config_files[i]);
+        r->config_files = i;
+        r->first_is_root = i > 0 &&
+            strcmp(query->config_files[0], "/.editorconfig") == 0;
+    }
+
+    /* a lookup of its own, reported in turn */
+    if (r->nested_path != NULL) {
+        editorconfig_handle h = editorconfig_handle_init();
+
+        ++ r->depth;
+        CHECK(editorconfig_parse(r->nested_path, h) == 0);
+        -- r->depth;
+        editorconfig_handle_destroy(h);
+    }
+}
+
+static char* data_path(const char* data_dir, const char* name)
+{
+    char*   path = (char*)malloc(strlen(data_dir) + strlen(name) + 2);
+
+    sprintf(path, "%s/%s", data_dir, name);
+    return path;
+}
+
+int main(int argc, char* argv[])
+{
+    editorconfig_handle h = editorconfig_handle_init();
+    reports             r;
+    char*               a_c;
+    char*               b_py;
+    char*               tree_conf;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    a_c = data_path(argv[1], "tree/a.c");
+    b_py = data_path(argv[1], "tree/b.py");
+    tree_conf = data_path(argv[1], "tree/.editorconfig");
+    memset(&r, 0, sizeof(r));
+
+    /* with no threshold, every lookup is reported, from the root down */
+    editorconfig_set_slow_query_callback(0, slow, &r);
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(r.calls == 1);
+    CHECK(r.err_num == 0);
+    CHECK(r.config_files > 1);
+    CHECK(r.first_is_root);
+    CHECK_STR(r.last_config_file, tree_conf);
+    CHECK(r.ancestors == (unsigned long long)r.config_files);
+    CHECK(r.total_ns > 0);
+
+    /* failed lookups too, before any conf file was looked for */
+    CHECK(editorconfig_parse("relative/a.c", h) ==
+            EDITORCONFIG_PARSE_NOT_FULL_PATH);
+    CHECK(r.calls == 2);
+    CHECK(r.err_num == EDITORCONFIG_PARSE_NOT_FULL_PATH);
+    CHECK(r.config_files == -1);
+
+    /* the callback may look up paths itself */
+    r.nested_path = b_py;
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(r.calls == 3);
+    CHECK(r.nested_calls == 1);
+    r.nested_path = NULL;
+
+    /* none is as slow as a minute */
+    editorconfig_set_slow_query_callback(60ULL * 1000000000ULL, slow, &r);
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(r.calls == 3);
+
+    /* nor reported once the callback is removed */
+    editorconfig_set_slow_query_callback(0, NULL, NULL);
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(r.calls == 3);
+
+    editorconfig_handle_destroy(h);
+    free(a_c);
+    free(b_py);
+    free(tree_conf);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * editorconfig_handle_get_stats(): a lookup from the disk and the same one
+ * from the cache are told apart, the times of the phases add up, and there
+ * are no statistics when they are off or when the lookup failed early.
+ *
+ * Usage: test_stats DATA_DIR
+ */
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+static char* data_path(const char* data_dir, const char* name)
+{
+    char*   path = (char*)malloc(strlen(data_dir) + strlen(name) + 2);
+
+    sprintf(path, "%s/%s", data_dir, name);
+    return path;
+}
+
+/* checks that the phases fit in the times that include them */
+static void check_times(const editorconfig_query_stats* s)
+{
+    CHECK(s->total_ns > 0);
+    CHECK(s->parse_ns >= s->glob_compile_ns + s->glob_match_ns);
+    CHECK(s->total_ns >= s->discover_ns + s->load_ns + s->parse_ns +
+            s->merge_ns);
+}
+
+int main(int argc, char* argv[])
+{
+    editorconfig_handle         h = editorconfig_handle_init();
+    editorconfig_query_stats    cold;
+    editorconfig_query_stats    warm;
+    editorconfig_query_stats    s;
+    struct stat                 st;
+    char*                       a_c;
+    char*                       d_c;
+    char*                       conf;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    a_c = data_path(argv[1], "tree/a.c");
+    d_c = data_path(argv[1], "tree/sub/d.c");
+    conf = data_path(argv[1], ".editorconfig");
+    CHECK(stat(conf, &st) == 0);
+
+    /* off by default */
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(editorconfig_handle_get_stats(h, &s) == -1);
+
+    /* on, with nothing cached: every directory up to the root is looked at
+     * on the disk, and the globs of data/.editorconfig are compiled */
+    editorconfig_clear_caches();
+    editorconfig_handle_set_stats_enabled(h, 1);
+    CHECK(editorconfig_handle_get_stats(h, &s) == -1);
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(editorconfig_handle_get_stats(h, &cold) == 0);
+    CHECK(cold.ancestors > 1);
+    CHECK(cold.configs_from_disk == cold.ancestors);
+    CHECK(cold.configs_from_cache == 0);
+    CHECK(cold.bytes_parsed >= (unsigned long long)st.st_size);
+    CHECK(cold.sections >= 7);
+    CHECK(cold.glob_compiles > 0);
+    CHECK(cold.glob_cache_misses == cold.glob_compiles);
+    CHECK(cold.glob_matches >= cold.sections);
+    check_times(&cold);
+
+    /* the same lookup again comes from the cache, doing the same work */
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(editorconfig_handle_get_stats(h, &warm) == 0);
+    CHECK(warm.ancestors == cold.ancestors);
+    CHECK(warm.configs_from_disk == 0);
+    CHECK(warm.configs_from_cache == cold.ancestors);
+    CHECK(warm.bytes_parsed == cold.bytes_parsed);
+    CHECK(warm.sections == cold.sections);
+    CHECK(warm.glob_compiles == 0);
+    CHECK(warm.glob_cache_misses == 0);
+    CHECK(warm.glob_cache_hits > 0);
+    CHECK(warm.glob_matches == cold.glob_matches);
+    check_times(&warm);
+
+    /* one directory further down, only that one is new */
+    CHECK(editorconfig_parse(d_c, h) == 0);
+    CHECK(editorconfig_handle_get_stats(h, &s) == 0);
+    CHECK(s.ancestors == cold.ancestors + 1);
+    CHECK(s.configs_from_disk == 1);
+    CHECK(s.configs_from_cache == cold.ancestors);
+
+    /* a lookup refused before it started leaves no statistics */
+    editorconfig_handle_set_version(h, 1000, 0, 0);
+    CHECK(editorconfig_parse(a_c, h) == EDITORCONFIG_PARSE_VERSION_TOO_NEW);
+    CHECK(editorconfig_handle_get_stats(h, &s) == -1);
+    editorconfig_handle_set_version(h, 0, 0, 0);
+
+    /* nor does turning them off */
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(editorconfig_handle_get_stats(h, &s) == 0);
+    editorconfig_handle_set_stats_enabled(h, 0);
+    CHECK(editorconfig_handle_get_stats(h, &s) == -1);
+
+    editorconfig_handle_destroy(h);
+    free(a_c);
+    free(d_c);
+    free(conf);
+
+    return TEST_RESULT();
+}
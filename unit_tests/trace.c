@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+/*
+ * editorconfig_set_trace_callback(): a lookup passes a span for each phase
+ * it went through, each within the "query" span that is passed last, and a
+ * lookup from the cache has nothing to load or compile.
+ *
+ * Usage: test_trace DATA_DIR
+ */
+
+#include <stdlib.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+/* the span names, in the order of editorconfig_trace_span */
+static const char* const span_names[] = {
+    "query", "discover", "load", "parse", "glob_compile", "glob_match",
+    "merge"
+};
+
+#define SPAN_NAME_COUNT     (sizeof(span_names) / sizeof(span_names[0]))
+#define MAX_SPANS           1024
+
+#define CONF_SUFFIX         "/.editorconfig"
+#define CONF_SUFFIX_LEN     (sizeof(CONF_SUFFIX) - 1)
+
+/* what the callback saw */
+typedef struct
+{
+    editorconfig_trace_span spans[MAX_SPANS];
+    int                     count;
+    int                     unknown_names;
+    int                     load_not_conf;
+    char                    query_subject[4096];
+} trace;
+
+static void traced(const editorconfig_trace_span* span, void* user)
+{
+    trace*      t = (trace*)user;
+    size_t      len = strlen(span->subject);
+    size_t      i;
+
+    for (i = 0; i < SPAN_NAME_COUNT; ++i)
+        if (strcmp(span->name, span_names[i]) == 0)
+            break;
+    if (i == SPAN_NAME_COUNT)
+        ++ t->unknown_names;
+    if (strcmp(span->name, "load") == 0 && (len < CONF_SUFFIX_LEN ||
+                strcmp(span->subject + len - CONF_SUFFIX_LEN,
+                    CONF_SUFFIX) != 0))
+        ++ t->load_not_conf;
+    if (strcmp(span->name, "query") == 0)
+        snprintf(t->query_subject, sizeof(t->query_subject), "%s",
+                span->subject);
+
+    /* the strings are only valid during the call, keep the names as
+     * ours */
+    if (t->count < MAX_SPANS) {
+        t->spans[t->count] = *span;
+        t->spans[t->count].name = i < SPAN_NAME_COUNT ? span_names[i] : "";
+        t->spans[t->count].subject = NULL;
+        ++ t->count;
+    }
+}
+
+/* the count of spans called name */
+static int count_spans(const trace* t, const char* name)
+{
+    int     count = 0;
+    int     i;
+
+    for (i = 0; i < t->count; ++i)
+        if (strcmp(t->spans[i].name, name) == 0)
+            ++ count;
+
+    return count;
+}
+
+/* checks that there is one query span, last, and all others are within it */
+static void check_nesting(const trace* t)
+{
+    const editorconfig_trace_span*  query;
+    int                             i;
+
+    CHECK(t->count > 0);
+    if (t->count == 0)
+        return;
+
+    query = &t->spans[t->count - 1];
+
+    CHECK_STR(query->name, "query");
+    CHECK(count_spans(t, "query") == 1);
+    for (i = 0; i < t->count - 1; ++i) {
+        CHECK(t->spans[i].start_ns >= query->start_ns);
+        CHECK(t->spans[i].start_ns + t->spans[i].duration_ns <=
+                query->start_ns + query->duration_ns);
+    }
+}
+
+static char* data_path(const char* data_dir, const char* name)
+{
+    char*   path = (char*)malloc(strlen(data_dir) + strlen(name) + 2);
+
+    sprintf(path, "%s/%s", data_dir, name);
+    return path;
+}
+
+int main(int argc, char* argv[])
+{
+    editorconfig_handle h = editorconfig_handle_init();
+    static trace        t;
+    char*               a_c;
+    size_t              i;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    a_c = data_path(argv[1], "tree/a.c");
+
+    /* cold, every phase shows up */
+    editorconfig_clear_caches();
+    editorconfig_set_trace_callback(traced, &t);
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(t.count < MAX_SPANS);
+    CHECK(t.unknown_names == 0);
+    CHECK(t.load_not_conf == 0);
+    CHECK_STR(t.query_subject, a_c);
+    for (i = 0; i < SPAN_NAME_COUNT; ++i)
+        CHECK(count_spans(&t, span_names[i]) > 0);
+    check_nesting(&t);
+
+    /* from the cache, nothing is loaded or compiled */
+    memset(&t, 0, sizeof(t));
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(count_spans(&t, "load") == 0);
+    CHECK(count_spans(&t, "glob_compile") == 0);
+    CHECK(count_spans(&t, "glob_match") > 0);
+    check_nesting(&t);
+
+    /* and nothing is passed once tracing is stopped */
+    editorconfig_set_trace_callback(NULL, NULL);
+    memset(&t, 0, sizeof(t));
+    CHECK(editorconfig_parse(a_c, h) == 0);
+    CHECK(t.count == 0);
+
+    editorconfig_handle_destroy(h);
+    free(a_c);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2011-2019 EditorConfig Team
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * editorconfig_try_parse(): a cold lookup is loaded in the background, after
+ * which the cache answers, also for config files that have a glob that does
+ * not compile or a syntax error.
+ *
+ * Usage: test_try_parse DATA_DIR
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include <editorconfig/editorconfig.h>
+
+#include "test.h"
+
+static pthread_mutex_t  done_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   done_cond = PTHREAD_COND_INITIALIZER;
+static int              done_count;
+static int              done_err_num;
+
+static void loaded(const char* full_filename, int err_num, void* user)
+{
+    (void)full_filename;
+    (void)user;
+
+    pthread_mutex_lock(&done_mutex);
+    done_err_num = err_num;
+    ++ done_count;
+    pthread_cond_signal(&done_cond);
+    pthread_mutex_unlock(&done_mutex);
+}
+
+/* waits for the count-th callback, returns its err_num */
+static int wait_done(int count)
+{
+    int     err_num;
+
+    pthread_mutex_lock(&done_mutex);
+    while (done_count < count)
+        pthread_cond_wait(&done_cond, &done_mutex);
+    err_num = done_err_num;
+    pthread_mutex_unlock(&done_mutex);
+
+    return err_num;
+}
+
+static char* data_path(const char* data_dir, const char* name)
+{
+    char*   path = (char*)malloc(strlen(data_dir) + strlen(name) + 2);
+
+    sprintf(path, "%s/%s", data_dir, name);
+    return path;
+}
+
+/* the value of name in h, or NULL */
+static const char* get_value(editorconfig_handle h, const char* name)
+{
+    int         count = editorconfig_handle_get_name_value_count(h);
+    int         i;
+
+    for (i = 0; i < count; ++i) {
+        const char* n;
+        const char* v;
+
+        editorconfig_handle_get_name_value(h, i, &n, &v);
+        if (strcmp(n, name) == 0)
+            return v;
+    }
+
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    editorconfig_handle h = editorconfig_handle_init();
+    char*               a_c;
+    char*               b_py;
+    char*               bad_glob;
+    char*               bad_syntax;
+    int                 callbacks = 0;
+    int                 err_num;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DATA_DIR\n", argv[0]);
+        return 2;
+    }
+    a_c = data_path(argv[1], "tree/a.c");
+    b_py = data_path(argv[1], "tree/b.py");
+    bad_glob = data_path(argv[1], "bad_glob/x.c");
+    bad_syntax = data_path(argv[1], "bad_syntax/x.c");
+
+    /* nothing is cached yet */
+    CHECK(editorconfig_try_parse(a_c, h, loaded, NULL) ==
+            EDITORCONFIG_PARSE_WOULD_BLOCK);
+    CHECK(wait_done(++ callbacks) == 0);
+    CHECK(editorconfig_try_parse(a_c, h, loaded, NULL) == 0);
+    CHECK(editorconfig_handle_get_name_value_count(h) == 4);
+    CHECK_STR(get_value(h, "indent_size"), "4");
+
+    /* the config files are shared with the rest of the directory, only the
+     * *.py glob is new */
+    err_num = editorconfig_try_parse(b_py, h, loaded, NULL);
+    if (err_num == EDITORCONFIG_PARSE_WOULD_BLOCK) {
+        CHECK(wait_done(++ callbacks) == 0);
+        err_num = editorconfig_try_parse(b_py, h, loaded, NULL);
+    }
+    CHECK(err_num == 0);
+    CHECK_STR(get_value(h, "indent_style"), "space");
+
+    /* a glob that does not compile is cached as such, so one load is
+     * enough */
+    CHECK(editorconfig_try_parse(bad_glob, h, loaded, NULL) ==
+            EDITORCONFIG_PARSE_WOULD_BLOCK);
+    CHECK(wait_done(++ callbacks) == 0);
+    CHECK(editorconfig_try_parse(bad_glob, h, loaded, NULL) == 0);
+    CHECK(editorconfig_handle_get_name_value_count(h) == 1);
+    CHECK_STR(get_value(h, "indent_style"), "space");
+
+    /* and a syntax error is reported from the cache as from the disk */
+    CHECK(editorconfig_try_parse(bad_syntax, h, loaded, NULL) ==
+            EDITORCONFIG_PARSE_WOULD_BLOCK);
+    CHECK(wait_done(++ callbacks) == 5);
+    CHECK(editorconfig_try_parse(bad_syntax, h, loaded, NULL) == 5);
+    CHECK(editorconfig_handle_get_err_file(h) != NULL &&
+            strstr(editorconfig_handle_get_err_file(h), "bad_syntax") != NULL);
+    CHECK(editorconfig_parse(bad_syntax, h) == 5);
+
+    editorconfig_handle_destroy(h);
+    free(a_c);
+    free(b_py);
+    free(bad_glob);
+    free(bad_syntax);
+
+    return TEST_RESULT();
+}